@@ -3,6 +3,7 @@
 #include <getopt.h>
 
 #include "svg.h"
+#include "scale.h"
 
 /* CLI argument handling. */
 
@@ -16,29 +17,63 @@ static void usage(const char *msg) {
         GUFF_VERSION_PATCH, GUFF_AUTHOR);
     fprintf(stderr,
         "\n"
-        "Usage: guff [-A] [-c] [-d WxH] [-f] [-h] [-l xyc]\n"
-        "            [-m MODE] [-r] [-s] [-S] [-x] [FILE]\n"
+        "Usage: guff [-A] [-b PX] [-c] [-d WxH] [-E] [-f] [-h] [-l xyc]\n"
+        "            [-m MODE] [-r] [-s] [-S] [-t TOL] [-w N[:K]] [-x]\n"
+        "            [-X MIN:MAX] [-Y MIN:MAX] [-z] [FILE]\n"
         "\n"
         "Common options:\n"
+        "    -b PX: heat map or hex cell size, in pixels (def: 8, or 4 in ASCII)\n"
         "    -d WxH: set width and height (e.g. \"-d 72x40\", \"-d 640x480\")\n"
         "    -f: flip x & y axes in plot\n"
         "    -h: print this message\n"
         "    -l LOG: any of 'x', 'y', 'c' -- set X, Y, and/or count to log scale\n"
-        "    -m MODE: dot, count, line (SVG only), default dot\n"
+        "    -m MODE: dot, count, line (SVG only), heat (SVG only), hex, default dot\n"
         "    -s: render to SVG\n"
+        "    -w N[:K]: plot a sliding window of the last N rows, redrawn every K rows (def: 1)\n"
         "    -x: treat first column as X for all following Y columns (def: use row count)\n"
+        "    -X MIN:MAX: pin the X axis's bounds, rather than fitting them to the data\n"
+        "    -Y MIN:MAX: pin the Y axis's bounds\n"
         "\n"
         "SVG only:\n"
         "    -c: use colorblind-safe default colors\n"
         "    -r: draw linear regression lines\n"
+        "    -t TOL: simplify lines, dropping detail under about TOL pixels\n"
+        "    -z: compact SVG, with one path per column and CSS classes for styles\n"
         "\n"
         "Other options:\n"
         "    -A: don't draw axes\n"
+        "    -E: use exact (libm) log for log scales, rather than a fast approximation\n"
         "    -S: disable stream mode\n"
         );
     exit(1);
 }
 
+static void parse_window(config *cfg, const char *opt) {
+    char *end = NULL;
+    long size = strtol(opt, &end, 10);
+    long step = 1;
+    if (*end == ':') { step = strtol(end + 1, &end, 10); }
+    if (*end != '\0' || size < 1 || step < 1) {
+        usage("Bad -w argument, should be formatted like -w 1000 or -w 1000:10");
+    }
+    cfg->window_size = size;
+    cfg->batch_rows = step;
+}
+
+static void parse_pin(axis_pin *pin, const char *opt, const char *msg) {
+    char *end = NULL;
+    double min = strtod(opt, &end);
+    if (end == opt || *end != ':') { usage(msg); }
+    const char *max_opt = end + 1;
+    double max = strtod(max_opt, &end);
+    if (end == max_opt || *end != '\0' || !(min < max) || isinf(min) || isinf(max)) {
+        usage(msg);
+    }
+    pin->pinned = true;
+    pin->min = min;
+    pin->max = max;
+}
+
 static void parse_dims(config *cfg, const char *opt) {
     char *x = strchr(opt, 'x');
     if (x) {
@@ -52,17 +87,26 @@ static void parse_dims(config *cfg, const char *opt) {
 
 void args_handle(config *cfg, int argc, char **argv) {
     int fl;
-    while ((fl = getopt(argc, argv, "Acd:fhl:m:rsSx")) != -1) {
+    while ((fl = getopt(argc, argv, "Ab:cd:Efhl:m:rsSt:w:xX:Y:z")) != -1) {
         switch (fl) {
         case 'A':               /* no axis */
             cfg->axis = false;
             break;
+        case 'b': {             /* heat map / hex bin size */
+            int bin = atoi(optarg);
+            if (bin < 1) { usage("Bad -b argument, should be a size in pixels, e.g. -b 8"); }
+            cfg->heat_bin = bin;
+            break;
+        }
         case 'c':               /* use colorblind-safe default colors */
             cfg->colorblind = true;
             break;
         case 'd':               /* dimensions */
             parse_dims(cfg, optarg);
             break;
+        case 'E':               /* exact log */
+            scale_set_exact_log(true);
+            break;
         case 'f':               /* flip x/y */
             cfg->flip_xy = true;
             break;
@@ -82,11 +126,14 @@ void args_handle(config *cfg, int argc, char **argv) {
             case 'd':
                 cfg->mode = MODE_DOT;
                 break;
+            case 'h':           /* "heat" or "hex" */
+                cfg->mode = (0 == strncmp(optarg, "hex", 3) ? MODE_HEX : MODE_HEAT);
+                break;
             case 'l':
                 cfg->mode = MODE_LINE;
                 break;
             default:
-                usage("Bad argument to -m: must be 'count', 'dot', or 'line'.");
+                usage("Bad argument to -m: must be 'count', 'dot', 'heat', 'hex', or 'line'.");
             }
             break;
         case 'r':               /* linear regression */
@@ -98,15 +145,43 @@ void args_handle(config *cfg, int argc, char **argv) {
         case 'S':               /* disable stream mode */
             cfg->stream_mode = false;
             break;
+        case 't': {             /* line simplification tolerance */
+            char *end = NULL;
+            double tol = strtod(optarg, &end);
+            if (end == optarg || *end != '\0' || !(tol >= 0) || isinf(tol)) {
+                usage("Bad -t argument, should be a tolerance in pixels, e.g. -t 0.5");
+            }
+            cfg->simplify_tol = tol;
+            break;
+        }
+        case 'w':               /* sliding window */
+            parse_window(cfg, optarg);
+            break;
         case 'x':               /* col 0 is X value */
             cfg->x_column = true;
             break;
+        case 'X':               /* pinned X bounds */
+            parse_pin(&cfg->pin_x, optarg,
+                "Bad -X argument, should be formatted like -X 0:100, with MIN < MAX");
+            break;
+        case 'Y':               /* pinned Y bounds */
+            parse_pin(&cfg->pin_y, optarg,
+                "Bad -Y argument, should be formatted like -Y 0:100, with MIN < MAX");
+            break;
+        case 'z':               /* compact SVG */
+            cfg->svg_compact = true;
+            break;
         case '?':
         default:
             usage(NULL);
         }
     }
 
+    if ((cfg->log_x && cfg->pin_x.pinned && cfg->pin_x.min <= 0)
+        || (cfg->log_y && cfg->pin_y.pinned && cfg->pin_y.min <= 0)) {
+        usage("Pinned bounds must be positive on a log-scaled axis.");
+    }
+
     argc -= (optind - 1);
     argv += (optind - 1);
     if (argc > 1) {
@@ -127,6 +202,7 @@ void args_handle(config *cfg, int argc, char **argv) {
 static void init_ascii(config *cfg) {
     if (cfg->width == 0) { cfg->width = 72; }
     if (cfg->height == 0) { cfg->height = 40; }
+    if (cfg->heat_bin == 0) { cfg->heat_bin = 4; }
 }
 
 static char *read_env_var(char *name) {
@@ -171,6 +247,7 @@ static void init_svg(config *cfg) {
     assert(theme);
     if (cfg->width == 0) { cfg->width = 320; }
     if (cfg->height == 0) { cfg->height = 200; }
+    if (cfg->heat_bin == 0) { cfg->heat_bin = 8; }
 
 
 #define DEF_STR_OPTION(VAR, ENV_VAR, DEFAULT)                           \
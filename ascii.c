@@ -1,5 +1,6 @@
 #include "ascii.h"
 #include "counter.h"
+#include "hexbin.h"
 #include "scale.h"
 
 /* Plotting to ASCII. */
@@ -9,24 +10,61 @@ static void draw_axes(plot_info *pi);
 static void print_header(plot_info *pi, bool point_counts, uint8_t columns);
 static char col_mark(uint8_t col);
 static void plot_points(config *cfg, plot_info *pi, data_set *ds);
+static void plot_counts(config *cfg, plot_info *pi, uint8_t columns);
+static void plot_hexes(config *cfg, plot_info *pi, uint8_t columns);
+static void begin_plot(config *cfg, plot_info *pi, uint8_t columns);
+static void end_plot(plot_info *pi);
 
 void free_rows(plot_info *pi);
 
 int ascii_plot(config *cfg, plot_info *pi, data_set *ds) {
+    begin_plot(cfg, pi, ds->columns);
+    if (cfg->mode == MODE_HEX) {
+        plot_hexes(cfg, pi, ds->columns);
+    } else if (pi->counters) {
+        plot_counts(cfg, pi, ds->columns);
+    } else {
+        plot_points(cfg, pi, ds);
+    }
+    end_plot(pi);
+    return 0;
+}
+
+int ascii_plot_counts(config *cfg, plot_info *pi, uint8_t columns) {
+    begin_plot(cfg, pi, columns);
+    if (cfg->mode == MODE_HEX) {
+        plot_hexes(cfg, pi, columns);
+    } else {
+        plot_counts(cfg, pi, columns);
+    }
+    end_plot(pi);
+    return 0;
+}
+
+/* Are points marked by their pixel's count? There's no room for a
+ * heat map's bins in ASCII, so it's drawn like count mode. */
+static bool shows_counts(config *cfg) {
+    return cfg->mode == MODE_COUNT || cfg->mode == MODE_HEAT;
+}
+
+/* Hexes are marked by their count relative to the densest hex. */
+static const char hex_marks[] = ".:-=+*#%@";
+
+static void begin_plot(config *cfg, plot_info *pi, uint8_t columns) {
     init_rows(pi);
     if (cfg->axis) {
         draw_calc_axis_pos(pi);
         draw_axes(pi);
     }
     
-    print_header(pi, cfg->mode == MODE_COUNT, ds->columns);
-    plot_points(cfg, pi, ds);
-    
+    print_header(pi, shows_counts(cfg) || cfg->mode == MODE_HEX, columns);
+}
+
+static void end_plot(plot_info *pi) {
     for (size_t i = 0; i < pi->h; i++) {
         printf("%s\n", pi->rows[i]);
     }
     free_rows(pi);
-    return 0;
 }
 
 void free_rows(plot_info *pi) {
@@ -108,29 +146,79 @@ static char col_mark(uint8_t col) {
     return col_marks[col];
 }
 
+static char count_mark(size_t count) {
+    if (count < 10) {
+        return '0' + count;
+    } else if (count < 36) {
+        return 'a' + count - 10;
+    } else {
+        return '#';
+    }
+}
+
 static void plot_points(config *cfg, plot_info *pi, data_set *ds) {
+    transform_t t = scale_get_plot_transform(pi);
+
+    scaled_point sps[SCALE_BLOCK];
+
     for (uint8_t c = 0; c < ds->columns; c++) {
-        for (size_t r = 0; r < ds->rows; r++) {
-            point *p = &ds->pairs[c][r];
-
-            if (IS_EMPTY(p->x) || IS_EMPTY(p->y)) { continue; }
-            transform_t t = scale_get_transform(pi->log_x, pi->log_y);
-            scaled_point sp;
-            scale_point(pi, p, &sp, t);
-            LOG(2, "{ %g, %g } => [%u, %u]\n", p->x, p->y, sp.x, sp.y);
-
-            char mark = col_mark(c);
-            if (pi->counters) {
-                size_t count = counter_get(pi->counters[c], sp.x, sp.y);
-                if (count < 10) {
-                    mark = '0' + count;
-                } else if (count < 36) {
-                    mark = 'a' + count - 10;
-                } else {
-                    mark = '#';
-                }
+        const double *xs = DS_XS(ds, c);
+        const double *ys = DS_YS(ds, c);
+        for (size_t r = 0; r < ds->rows; r += SCALE_BLOCK) {
+            size_t block = ds->rows - r;
+            if (block > SCALE_BLOCK) { block = SCALE_BLOCK; }
+            scale_points(pi, &xs[r], &ys[r], block, t, sps);
+
+            for (size_t i = 0; i < block; i++) {
+                scaled_point sp = sps[i];
+                if (sp.x == SCALED_EMPTY) { continue; }
+                LOG(2, "{ %g, %g } => [%d, %d]\n", xs[r + i], ys[r + i], sp.x, sp.y);
+
+                pi->rows[sp.y][sp.x] = col_mark(c);
+            }
+        }
+    }
+}
+
+/* Mark each occupied pixel in PI's counters once, rather than once
+ * per point counted there. Later columns are drawn over earlier ones,
+ * as with plot_points. */
+static void plot_counts(config *cfg, plot_info *pi, uint8_t columns) {
+    for (uint8_t c = 0; c < columns; c++) {
+        size_t pos = 0;
+        counter_cell cell;
+        while (counter_next(pi->counters[c], &pos, &cell)) {
+            pi->rows[cell.y][cell.x] = (shows_counts(cfg)
+                ? count_mark(cell.count) : col_mark(c));
+        }
+    }
+}
+
+/* Bin every column's points into hexes, and mark each occupied hex's
+ * center with a glyph for its density. */
+static void plot_hexes(config *cfg, plot_info *pi, uint8_t columns) {
+    hex_grid g = { .counts = NULL };
+    hexbin_init(&g, pi->w, pi->h, cfg->heat_bin);
+    hexbin_count(&g, pi, columns);
+
+    const size_t levels = sizeof(hex_marks) - 1;
+    for (size_t row = 0; row < g.rows; row++) {
+        for (size_t col = 0; col < g.cols; col++) {
+            uint64_t count = g.counts[row * g.cols + col];
+            if (count == 0) { continue; }
+            double t = (double)count / g.max;
+            if (cfg->log_count) {
+                t = (g.max > 1 ? scale_log(count) / scale_log(g.max) : 1);
             }
-            pi->rows[sp.y][sp.x] = mark;
+            size_t level = (size_t)(t * (levels - 1) + 0.5);
+
+            double cx, cy;
+            hexbin_center(&g, col, row, &cx, &cy);
+            // a hex at the edge may be centered just off the plot
+            size_t x = (cx < pi->w ? (size_t)cx : pi->w - 1);
+            size_t y = (cy < pi->h ? (size_t)cy : pi->h - 1);
+            pi->rows[y][x] = hex_marks[level];
         }
     }
+    hexbin_free(&g);
 }
@@ -6,4 +6,8 @@
 
 int ascii_plot(config *cfg, plot_info *pi, data_set *ds);
 
+/* Plot COLUMNS columns' points from their counts in pi->counters,
+ * rather than from a data_set. */
+int ascii_plot_counts(config *cfg, plot_info *pi, uint8_t columns);
+
 #endif
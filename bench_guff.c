@@ -0,0 +1,325 @@
+#define _POSIX_C_SOURCE 200809L
+#include "guff.h"
+
+#include <time.h>
+
+#include "parse.h"
+#include "scan.h"
+#include "scale.h"
+#include "bounds.h"
+#include "draw.h"
+#include "parallel.h"
+#include "test_guff.h"
+
+/* Throughput benchmarks for guff's hot loops. */
+
+#define DEF_BENCH(NAME) static void NAME(void)
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, size_t count, size_t bytes, double secs) {
+    printf("%-28s %10.2f ns/item %10.1f MB/s\n", name,
+        1e9 * secs / count, bytes / secs / 1e6);
+}
+
+#define NUMBER_COUNT (1000 * 1000)
+#define ROUNDS 10
+
+/* Fill buf with NUMBER_COUNT space-separated numbers, formatted like
+ * typical metric dumps: integers, fixed-point, and scientific. */
+static size_t gen_numbers(char *buf, size_t size) {
+    uint64_t state = 1;
+    size_t o = 0;
+    for (size_t i = 0; i < NUMBER_COUNT; i++) {
+        double v = prng(&state) / 1000.0;
+        switch (i % 3) {
+        case 0: o += snprintf(&buf[o], size - o, "%u ", prng(&state) % 100000); break;
+        case 1: o += snprintf(&buf[o], size - o, "%.3f ", v); break;
+        case 2: o += snprintf(&buf[o], size - o, "%.6e ", v); break;
+        }
+    }
+    return o;
+}
+
+DEF_BENCH(bench_parse) {
+    size_t size = 32 * NUMBER_COUNT;
+    char *buf = malloc(size);
+    assert(buf);
+    size_t len = gen_numbers(buf, size);
+    const char *end = &buf[len];
+
+    volatile double sink = 0;
+    double t0 = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        char *p = buf;
+        while (p < end) {
+            char *out = NULL;
+            sink += strtod(p, &out);
+            p = out + 1;
+        }
+    }
+    double t_strtod = now() - t0;
+
+    t0 = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        const char *p = buf;
+        while (p < end) {
+            const char *out = NULL;
+            sink += parse_double(p, end, &out);
+            p = out + 1;
+        }
+    }
+    double t_parse = now() - t0;
+    (void)sink;
+
+    report("strtod", ROUNDS * NUMBER_COUNT, ROUNDS * len, t_strtod);
+    report("parse_double", ROUNDS * NUMBER_COUNT, ROUNDS * len, t_parse);
+    free(buf);
+}
+
+static size_t count_lines(const char *p, const char *end) {
+    size_t lines = 0;
+    while (p < end) {
+        p = scan_newline(p, end) + 1;
+        lines++;
+    }
+    return lines;
+}
+
+DEF_BENCH(bench_scan) {
+    size_t size = 32 * NUMBER_COUNT;
+    char *buf = malloc(size);
+    assert(buf);
+    size_t len = gen_numbers(buf, size);
+    const char *end = &buf[len];
+
+    /* 8 cells per line */
+    for (size_t i = 0, cells = 0; i < len; i++) {
+        if (buf[i] == ' ' && ++cells % 8 == 0) { buf[i] = '\n'; }
+    }
+
+    struct {
+        const char *name;
+        scan_impl_t impl;
+    } impls[] = {
+        { "scan_newline (scalar)", SCAN_IMPL_SCALAR },
+        { "scan_newline (sse2)", SCAN_IMPL_SSE2 },
+        { "scan_newline (avx2)", SCAN_IMPL_AVX2 },
+    };
+
+    for (size_t i = 0; i < sizeof(impls)/sizeof(impls[0]); i++) {
+        if (!scan_set_impl(impls[i].impl)) { continue; }
+        volatile size_t lines = 0;
+        double t0 = now();
+        for (int r = 0; r < ROUNDS; r++) {
+            lines += count_lines(buf, end);
+        }
+        double t = now() - t0;
+        report(impls[i].name, lines, ROUNDS * len, t);
+    }
+    free(buf);
+}
+
+DEF_BENCH(bench_scale) {
+    double *xs = malloc(NUMBER_COUNT * sizeof(*xs));
+    double *ys = malloc(NUMBER_COUNT * sizeof(*ys));
+    scaled_point *out = malloc(NUMBER_COUNT * sizeof(*out));
+    assert(xs && ys && out);
+    uint64_t state = 3;
+    for (size_t i = 0; i < NUMBER_COUNT; i++) {
+        xs[i] = 1 + prng(&state) % 10000;
+        ys[i] = 1 + prng(&state) % 10000;
+    }
+
+    plot_info pi = {
+        .min_x = 0, .max_x = 10000, .range_x = 10000,
+        .min_y = 0, .max_y = 10000, .range_y = 10000,
+        .w = 640, .h = 480,
+    };
+
+    volatile int32_t sink = 0;
+    double t0 = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < NUMBER_COUNT; i++) {
+            point p = { .x = xs[i], .y = ys[i] };
+            scale_point(&pi, &p, &out[i], TRANSFORM_NONE);
+        }
+        sink += out[NUMBER_COUNT - 1].x;
+    }
+    double t_single = now() - t0;
+
+    t0 = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < NUMBER_COUNT; i += SCALE_BLOCK) {
+            size_t count = NUMBER_COUNT - i;
+            if (count > SCALE_BLOCK) { count = SCALE_BLOCK; }
+            scale_points(&pi, &xs[i], &ys[i], count, TRANSFORM_NONE, &out[i]);
+        }
+        sink += out[NUMBER_COUNT - 1].x;
+    }
+    double t_batch = now() - t0;
+    (void)sink;
+
+    size_t bytes = ROUNDS * NUMBER_COUNT * 2 * sizeof(double);
+    report("scale_point", ROUNDS * NUMBER_COUNT, bytes, t_single);
+    report("scale_points", ROUNDS * NUMBER_COUNT, bytes, t_batch);
+    free(xs);
+    free(ys);
+    free(out);
+}
+
+/* The per-point loop draw_calc_bounds used before bounds_scan. */
+static void branchy_bounds(const data_set *ds, point *min, point *max) {
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        const double *xs = DS_XS(ds, c);
+        const double *ys = DS_YS(ds, c);
+        for (size_t r = 0; r < ds->rows; r++) {
+            double x = xs[r];
+            double y = ys[r];
+            if (IS_EMPTY(x) || IS_EMPTY(y)) { continue; }
+            if (x < min->x) { min->x = x; }
+            if (x > max->x) { max->x = x; }
+            if (y < min->y) { min->y = y; }
+            if (y > max->y) { max->y = y; }
+        }
+    }
+}
+
+DEF_BENCH(bench_bounds) {
+    enum { COLUMNS = 4 };
+    double *xs = malloc(NUMBER_COUNT * sizeof(*xs));
+    double *ys[COLUMNS];
+    assert(xs);
+    uint64_t state = 7;
+    for (size_t i = 0; i < NUMBER_COUNT; i++) { xs[i] = i; }
+    for (size_t c = 0; c < COLUMNS; c++) {
+        ys[c] = malloc(NUMBER_COUNT * sizeof(*ys[c]));
+        assert(ys[c]);
+        for (size_t i = 0; i < NUMBER_COUNT; i++) {
+            ys[c][i] = (prng(&state) % 16 == 0 ? EMPTY_VALUE : prng(&state) / 1000.0);
+        }
+    }
+    data_set ds = { .columns = COLUMNS, .rows = NUMBER_COUNT, .xs = xs, .ys = ys };
+    size_t count = ROUNDS * NUMBER_COUNT * COLUMNS;
+    size_t bytes = count * 2 * sizeof(double);
+
+    volatile double sink = 0;
+    double t0 = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        point min = { .x = 1e100, .y = 1e100 };
+        point max = { .x = -1e100, .y = -1e100 };
+        branchy_bounds(&ds, &min, &max);
+        sink += min.y + max.y;
+    }
+    report("bounds (branchy)", count, bytes, now() - t0);
+
+    size_t threads = parallel_threads();
+    for (int parallel = 0; parallel <= (threads > 1); parallel++) {
+        parallel_set_threads(parallel ? threads : 1);
+        t0 = now();
+        for (int r = 0; r < ROUNDS; r++) {
+            point min, max;
+            bounds_scan(&ds, &min, &max);
+            sink += min.y + max.y;
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "bounds_scan (%zu thread%s)",
+            parallel ? threads : 1, parallel ? "s" : "");
+        report(name, count, bytes, now() - t0);
+    }
+    (void)sink;
+    parallel_set_threads(threads);
+
+    free(xs);
+    for (size_t c = 0; c < COLUMNS; c++) { free(ys[c]); }
+}
+
+/* Log-scaling a frame's columns (as draw does for -l x / -l y), with
+ * libm's log(3) vs. the default approximation. */
+DEF_BENCH(bench_log) {
+    double *xs = malloc(NUMBER_COUNT * sizeof(*xs));
+    double *ys = malloc(NUMBER_COUNT * sizeof(*ys));
+    assert(xs && ys);
+    uint64_t state = 5;
+    for (size_t i = 0; i < NUMBER_COUNT; i++) {
+        xs[i] = 1 + i;
+        ys[i] = 1 + prng(&state) / 1000.0;
+    }
+
+    data_set ds = { .columns = 1, .rows = NUMBER_COUNT, .xs = xs, .ys = &ys };
+    struct transform_cache *cache = NULL;
+    data_set logged;
+    // allocate the cache before timing
+    scale_transform_data_set(&cache, &ds, TRANSFORM_LOG_XY, &logged);
+
+    const char *names[] = { "log (libm)", "log (fast)" };
+    size_t bytes = ROUNDS * NUMBER_COUNT * 2 * sizeof(double);
+
+    for (int fast = 0; fast <= 1; fast++) {
+        scale_set_exact_log(!fast);
+        volatile double sink = 0;
+        double t0 = now();
+        for (int r = 0; r < ROUNDS; r++) {
+            scale_transform_data_set(&cache, &ds, TRANSFORM_LOG_XY, &logged);
+            sink += logged.ys[0][NUMBER_COUNT - 1];
+        }
+        double t = now() - t0;
+        (void)sink;
+        report(names[fast], ROUNDS * NUMBER_COUNT * 2, bytes, t);
+    }
+    scale_set_exact_log(false);
+    scale_free_transform_cache(cache);
+    free(xs);
+    free(ys);
+}
+
+/* Count mode's per-pixel counting, serially and across threads. */
+DEF_BENCH(bench_count) {
+    enum { COLUMNS = 2 };
+    double *xs = malloc(NUMBER_COUNT * sizeof(*xs));
+    double *ys[COLUMNS];
+    assert(xs);
+    uint64_t state = 9;
+    for (size_t i = 0; i < NUMBER_COUNT; i++) { xs[i] = i; }
+    for (size_t c = 0; c < COLUMNS; c++) {
+        ys[c] = malloc(NUMBER_COUNT * sizeof(*ys[c]));
+        assert(ys[c]);
+        for (size_t i = 0; i < NUMBER_COUNT; i++) { ys[c][i] = prng(&state) % 10000; }
+    }
+    data_set ds = { .columns = COLUMNS, .rows = NUMBER_COUNT, .xs = xs, .ys = ys };
+    plot_info pi = { .w = 640, .h = 480 };
+    draw_calc_bounds(&ds, &pi);
+    config cfg = { .mode = MODE_COUNT };
+    size_t count = ROUNDS * NUMBER_COUNT * COLUMNS;
+    size_t bytes = count * 2 * sizeof(double);
+
+    size_t threads = parallel_threads();
+    for (int parallel = 0; parallel <= (threads > 1); parallel++) {
+        parallel_set_threads(parallel ? threads : 1);
+        double t0 = now();
+        for (int r = 0; r < ROUNDS; r++) { draw_count(&cfg, &pi, &ds); }
+        char name[64];
+        snprintf(name, sizeof(name), "draw_count (%zu thread%s)",
+            parallel ? threads : 1, parallel ? "s" : "");
+        report(name, count, bytes, now() - t0);
+    }
+    parallel_set_threads(threads);
+
+    draw_close(&cfg);
+    free(xs);
+    for (size_t c = 0; c < COLUMNS; c++) { free(ys[c]); }
+}
+
+int main(int argc, char **argv) {
+    bench_parse();
+    bench_scan();
+    bench_scale();
+    bench_log();
+    bench_bounds();
+    bench_count();
+    return 0;
+}
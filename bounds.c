@@ -0,0 +1,142 @@
+#include "bounds.h"
+#include "parallel.h"
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define BOUNDS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* Min/max of complete points. */
+
+/* Only split the scan across threads if there are at least this many
+ * values, and give each thread at least half as many. */
+#define PARALLEL_MIN_VALUES (1024 * 1024)
+
+/* Running bounds. Until a complete point is seen, min > max. */
+struct acc {
+    double min_x;
+    double max_x;
+    double min_y;
+    double max_y;
+};
+
+static const struct acc acc_init = {
+    .min_x = INFINITY, .max_x = -INFINITY,
+    .min_y = INFINITY, .max_y = -INFINITY,
+};
+
+static void merge(struct acc *a, const struct acc *b) {
+    a->min_x = (b->min_x < a->min_x ? b->min_x : a->min_x);
+    a->max_x = (b->max_x > a->max_x ? b->max_x : a->max_x);
+    a->min_y = (b->min_y < a->min_y ? b->min_y : a->min_y);
+    a->max_y = (b->max_y > a->max_y ? b->max_y : a->max_y);
+}
+
+/* Empty points are masked to values that can't change the bounds,
+ * rather than being skipped, so there are no branches. */
+static void scan_scalar(const double *xs, const double *ys,
+        size_t from, size_t to, struct acc *a) {
+    for (size_t i = from; i < to; i++) {
+        double x = xs[i];
+        double y = ys[i];
+        bool ok = !IS_EMPTY(x) & !IS_EMPTY(y);
+        double lx = (ok ? x : INFINITY);
+        double hx = (ok ? x : -INFINITY);
+        double ly = (ok ? y : INFINITY);
+        double hy = (ok ? y : -INFINITY);
+        a->min_x = (lx < a->min_x ? lx : a->min_x);
+        a->max_x = (hx > a->max_x ? hx : a->max_x);
+        a->min_y = (ly < a->min_y ? ly : a->min_y);
+        a->max_y = (hy > a->max_y ? hy : a->max_y);
+    }
+}
+
+#ifdef BOUNDS_SSE2
+static double hmin(__m128d v) {
+    return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static double hmax(__m128d v) {
+    return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+static void scan_sse2(const double *xs, const double *ys,
+        size_t from, size_t to, struct acc *a) {
+    const __m128d pos_inf = _mm_set1_pd(INFINITY);
+    const __m128d neg_inf = _mm_set1_pd(-INFINITY);
+    __m128d min_x = pos_inf, max_x = neg_inf;
+    __m128d min_y = pos_inf, max_y = neg_inf;
+
+    size_t i = from;
+    for (; i + 2 <= to; i += 2) {
+        __m128d x = _mm_loadu_pd(&xs[i]);
+        __m128d y = _mm_loadu_pd(&ys[i]);
+        // all ones where neither X nor Y is NaN (empty)
+        __m128d ok = _mm_and_pd(_mm_cmpord_pd(x, x), _mm_cmpord_pd(y, y));
+        __m128d lx = _mm_or_pd(_mm_and_pd(ok, x), _mm_andnot_pd(ok, pos_inf));
+        __m128d hx = _mm_or_pd(_mm_and_pd(ok, x), _mm_andnot_pd(ok, neg_inf));
+        __m128d ly = _mm_or_pd(_mm_and_pd(ok, y), _mm_andnot_pd(ok, pos_inf));
+        __m128d hy = _mm_or_pd(_mm_and_pd(ok, y), _mm_andnot_pd(ok, neg_inf));
+        min_x = _mm_min_pd(lx, min_x);
+        max_x = _mm_max_pd(hx, max_x);
+        min_y = _mm_min_pd(ly, min_y);
+        max_y = _mm_max_pd(hy, max_y);
+    }
+
+    struct acc lanes = {
+        .min_x = hmin(min_x), .max_x = hmax(max_x),
+        .min_y = hmin(min_y), .max_y = hmax(max_y),
+    };
+    scan_scalar(xs, ys, i, to, &lanes);
+    merge(a, &lanes);
+}
+#endif
+
+static void scan_rows(const data_set *ds, size_t from, size_t to, struct acc *a) {
+    for (uint8_t c = 0; c < ds->columns; c++) {
+#ifdef BOUNDS_SSE2
+        scan_sse2(DS_XS(ds, c), DS_YS(ds, c), from, to, a);
+#else
+        scan_scalar(DS_XS(ds, c), DS_YS(ds, c), from, to, a);
+#endif
+    }
+}
+
+struct task {
+    const data_set *ds;
+    size_t count;
+    struct acc *accs;
+};
+
+static void scan_task(size_t i, void *udata) {
+    struct task *t = udata;
+    size_t rows = t->ds->rows;
+    size_t from = i * (rows / t->count);
+    size_t to = (i == t->count - 1 ? rows : from + rows / t->count);
+    t->accs[i] = acc_init;
+    scan_rows(t->ds, from, to, &t->accs[i]);
+}
+
+bool bounds_scan(const data_set *ds, point *min, point *max) {
+    struct acc a = acc_init;
+    size_t values = ds->rows * ds->columns;
+    size_t count = values / (PARALLEL_MIN_VALUES / 2);
+    if (count > parallel_threads()) { count = parallel_threads(); }
+
+    if (values < PARALLEL_MIN_VALUES || count <= 1) {
+        scan_rows(ds, 0, ds->rows, &a);
+    } else {
+        struct acc *accs = malloc(count * sizeof(*accs));
+        if (accs == NULL) { err(1, "malloc"); }
+        struct task t = { .ds = ds, .count = count, .accs = accs };
+        LOG(1, "scanning bounds of %zu values in %zu chunks\n", values, count);
+        parallel_run(count, scan_task, &t);
+        for (size_t i = 0; i < count; i++) { merge(&a, &accs[i]); }
+        free(accs);
+    }
+
+    if (!(a.min_x <= a.max_x)) { return false; }
+    *min = (point){ .x = a.min_x, .y = a.min_y };
+    *max = (point){ .x = a.max_x, .y = a.max_y };
+    return true;
+}
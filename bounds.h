@@ -0,0 +1,15 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "guff.h"
+
+/* Bounds of a data_set's complete points (those with both an X and a
+ * Y), as plotted, so X and Y are swapped if the data_set is flipped.
+ * Each column is scanned in a single branch-free pass, two values at a
+ * time with SSE2, and large data_sets are split across threads. */
+
+/* Set *MIN and *MAX to the bounds of DS's complete points. Returns
+ * false (leaving them unchanged) if there are none. */
+bool bounds_scan(const data_set *ds, point *min, point *max);
+
+#endif
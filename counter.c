@@ -1,81 +1,315 @@
 #include "counter.h"
-#include "fnv.h"
 
-/* Hash table, for tracking point counts. */
+/* Point counts, by scaled (pixel) coordinates. Usually this is a dense
+ * grid with a cell per pixel, but if the grid would be huge it falls
+ * back to a hash table sized by the number of points instead. */
 
 typedef struct {
-    size_t x;
-    size_t y;
-    size_t count;
+    uint32_t key;               /* y * w + x, or EMPTY_KEY */
+    uint32_t count;
 } bucket;
 
 struct counter {
-    uint8_t bucket_ceil2;
-    size_t bucket_count;
-    bucket buckets[];
+    size_t w;
+    size_t h;
+
+    /* Dense grid of w*h cells, row-major, plus one extra cell at the
+     * end that absorbs out-of-range points. NULL if sparse. */
+    uint32_t *cells;
+
+    /* Otherwise, a Robin Hood hash table, which grows as it fills. */
+    size_t bucket_count;        /* power of 2 */
+    size_t used;
+    size_t max_probe;
+    bucket *buckets;
+
+    /* The used buckets, sorted by key, for counter_next. */
+    bucket *sorted;
+    size_t sorted_alloc;
 };
 
-#define EMPTY_BUCKET ((size_t)-1)
+#define EMPTY_KEY UINT32_MAX
 
-/* Alloc a hash table with 2*ceil(rows) buckets. */
-counter *counter_init(size_t rows) {
-    size_t ceil = rows;
-    uint8_t ceil2 = 2;
-    while ((1 << ceil2) < ceil) { ceil2++; }
-    ceil2++;
-    size_t bucket_count = 1 << ceil2;
+/* Grids up to this many cells are always dense; larger ones are only
+ * dense if they'd still be smaller than the sparse table. */
+#define DENSE_MAX_CELLS (1 << 24)
 
-    size_t size = sizeof(counter) + bucket_count * sizeof(bucket);
-    counter *c = malloc(size);
-    if (c) {
-        c->bucket_ceil2 = ceil2;
-        c->bucket_count = bucket_count;
-        for (size_t i = 0; i < bucket_count; i++) {
-            c->buckets[i].x = EMPTY_BUCKET;
-            c->buckets[i].y = EMPTY_BUCKET;
+/* The sparse table starts with room for at most this many buckets,
+ * and then grows whenever it gets over 3/4 full. */
+#define SPARSE_MAX_INITIAL (1 << 16)
+#define SPARSE_MIN_INITIAL 16
+
+static size_t sparse_initial_size(size_t rows) {
+    size_t size = SPARSE_MIN_INITIAL;
+    while (size < SPARSE_MAX_INITIAL && size * 3 / 4 < rows) { size <<= 1; }
+    return size;
+}
+
+static bool use_dense(size_t w, size_t h, size_t rows) {
+    size_t cells = w * h;
+    if (cells <= DENSE_MAX_CELLS) { return true; }
+    return cells * sizeof(uint32_t) < 2 * rows * sizeof(bucket);
+}
+
+static void clear(counter *c) {
+    if (c->cells) {
+        memset(c->cells, 0, (c->w * c->h + 1) * sizeof(*c->cells));
+    } else {
+        for (size_t i = 0; i < c->bucket_count; i++) {
+            c->buckets[i].key = EMPTY_KEY;
+        }
+        c->used = 0;
+        c->max_probe = 0;
+    }
+}
+
+static bool alloc_buckets(counter *c, size_t bucket_count) {
+    bucket *buckets = malloc(bucket_count * sizeof(*buckets));
+    if (buckets == NULL) { return false; }
+    c->buckets = buckets;
+    c->bucket_count = bucket_count;
+    clear(c);
+    return true;
+}
+
+counter *counter_init(size_t w, size_t h, size_t rows) {
+    // sparse keys pack each cell's index into 32 bits
+    if ((uint64_t)w * h >= EMPTY_KEY) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+
+    counter *c = calloc(1, sizeof(*c));
+    if (c == NULL) { return NULL; }
+    c->w = w;
+    c->h = h;
+
+    if (use_dense(w, h, rows)) {
+        c->cells = calloc(w * h + 1, sizeof(*c->cells));
+        if (c->cells == NULL) {
+            free(c);
+            return NULL;
         }
+    } else if (!alloc_buckets(c, sparse_initial_size(rows))) {
+        free(c);
+        return NULL;
     }
     return c;
 }
 
-size_t point_hash(size_t x, size_t y) {
-    size_t buf_size = 2*sizeof(size_t);
-    uint8_t buf[buf_size];
-    memcpy(&buf[0], &x, sizeof(x));
-    memcpy(&buf[sizeof(x)], &y, sizeof(y));
-    return (size_t)fnv1a(buf, buf_size);
+counter *counter_reset(counter *c, size_t w, size_t h, size_t rows) {
+    if (c && c->w == w && c->h == h && use_dense(w, h, rows) == (c->cells != NULL)) {
+        clear(c);               // a sparse table keeps the size it grew to
+        return c;
+    }
+    counter_free(c);
+    return counter_init(w, h, rows);
+}
+
+/* Integer mixer (lowbias32, by Chris Wellons): every input bit
+ * affects every output bit, so nearby pixels spread across the table. */
+static uint32_t hash_key(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/* How far bucket I is from KEY's preferred bucket. */
+static size_t probe_distance(counter *c, uint32_t key, size_t i) {
+    return (i - hash_key(key)) & (c->bucket_count - 1);
 }
 
-static bucket *find_bucket(counter *c, size_t x, size_t y) {
-    size_t hash = point_hash(x, y);
+/* Find KEY's bucket, or NULL. Since Robin Hood insertion keeps the
+ * buckets along a probe sequence ordered by distance, the search can
+ * stop at the first bucket closer to home than KEY would be. */
+static bucket *find_bucket(counter *c, uint32_t key) {
     size_t mask = c->bucket_count - 1;
-    for (size_t i = 0; i < c->bucket_count; i++) {
-        size_t bi = (hash + i) & mask;
-        bucket *b = &c->buckets[bi];
-        if (b->x == x && b->y == y) {
-            return b;
-        } else if (b->x == EMPTY_BUCKET) {
-            b->x = x;
-            b->y = y;
-            b->count = 0;
-            return b;
-        }
+    size_t i = hash_key(key) & mask;
+    for (size_t dist = 0; dist <= c->max_probe; dist++) {
+        bucket *b = &c->buckets[i];
+        if (b->key == key) { return b; }
+        if (b->key == EMPTY_KEY || probe_distance(c, b->key, i) < dist) { break; }
+        i = (i + 1) & mask;
     }
     return NULL;
 }
 
+/* Insert a key known not to be present. Whenever it passes a bucket
+ * closer to home than it is, the two swap, which keeps the longest
+ * probe sequences short. */
+static void insert(counter *c, uint32_t key, uint32_t count) {
+    size_t mask = c->bucket_count - 1;
+    bucket cur = { .key = key, .count = count };
+    size_t i = hash_key(key) & mask;
+    size_t dist = 0;
+    for (;;) {
+        bucket *b = &c->buckets[i];
+        if (b->key == EMPTY_KEY) {
+            *b = cur;
+            c->used++;
+            if (dist > c->max_probe) { c->max_probe = dist; }
+            return;
+        }
+        size_t b_dist = probe_distance(c, b->key, i);
+        if (b_dist < dist) {
+            bucket tmp = *b;
+            *b = cur;
+            cur = tmp;
+            if (dist > c->max_probe) { c->max_probe = dist; }
+            dist = b_dist;
+        }
+        i = (i + 1) & mask;
+        dist++;
+    }
+}
+
+static void grow(counter *c) {
+    bucket *old = c->buckets;
+    size_t old_count = c->bucket_count;
+    LOG(1, "growing counter: %zu => %zu buckets\n", old_count, 2 * old_count);
+    if (!alloc_buckets(c, 2 * old_count)) { err(1, "malloc"); }
+
+    for (size_t i = 0; i < old_count; i++) {
+        if (old[i].key != EMPTY_KEY) { insert(c, old[i].key, old[i].count); }
+    }
+    free(old);
+}
+
+/* Index of (x, y)'s cell, or of the overflow cell if it's off the grid. */
+static size_t cell_index(counter *c, size_t x, size_t y) {
+    size_t in_range = (x < c->w) & (y < c->h);
+    size_t cells = c->w * c->h;
+    return in_range * (y * c->w + x) + (1 - in_range) * cells;
+}
+
+/* Add COUNT to a sparse table's count for KEY. */
+static void add_key(counter *c, uint32_t key, uint32_t count) {
+    bucket *b = find_bucket(c, key);
+    if (b) {
+        b->count += count;
+        return;
+    }
+    if (4 * (c->used + 1) > 3 * c->bucket_count) { grow(c); }
+    insert(c, key, count);
+}
+
 void counter_increment(counter *c, size_t x, size_t y) {
-    bucket *b = find_bucket(c, x, y);
-    assert(b);
-    b->count++;
+    if (c->cells) {
+        c->cells[cell_index(c, x, y)]++;
+        return;
+    }
+    if (x >= c->w || y >= c->h) { return; }
+    add_key(c, y * c->w + x, 1);
+}
+
+void counter_merge(counter *dst, const counter *src) {
+    assert(dst->w == src->w && dst->h == src->h);
+    size_t cells = src->w * src->h;
+
+    if (src->cells) {
+        if (dst->cells) {       // the common case, which vectorizes
+            for (size_t i = 0; i < cells; i++) { dst->cells[i] += src->cells[i]; }
+            return;
+        }
+        for (size_t i = 0; i < cells; i++) {
+            if (src->cells[i] > 0) { add_key(dst, i, src->cells[i]); }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < src->bucket_count; i++) {
+        bucket b = src->buckets[i];
+        if (b.key == EMPTY_KEY) { continue; }
+        if (dst->cells) {
+            dst->cells[b.key] += b.count;
+        } else {
+            add_key(dst, b.key, b.count);
+        }
+    }
 }
 
 size_t counter_get(counter *c, size_t x, size_t y) {
-    bucket *b = find_bucket(c, x, y);
-    assert(b);
-    return b->count;
+    if (x >= c->w || y >= c->h) { return 0; }
+    if (c->cells) { return c->cells[y * c->w + x]; }
+    bucket *b = find_bucket(c, y * c->w + x);
+    return (b ? b->count : 0);
+}
+
+static int cmp_key(const void *a, const void *b) {
+    uint32_t ka = ((const bucket *)a)->key;
+    uint32_t kb = ((const bucket *)b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+/* Copy the used buckets into c->sorted, in key (row-major) order. */
+static void sort_used(counter *c) {
+    if (c->used == 0) { return; }
+    if (c->used > c->sorted_alloc) {
+        bucket *nsorted = realloc(c->sorted, c->used * sizeof(*nsorted));
+        if (nsorted == NULL) { err(1, "realloc"); }
+        c->sorted = nsorted;
+        c->sorted_alloc = c->used;
+    }
+    size_t o = 0;
+    for (size_t i = 0; i < c->bucket_count; i++) {
+        if (c->buckets[i].key != EMPTY_KEY) { c->sorted[o++] = c->buckets[i]; }
+    }
+    qsort(c->sorted, o, sizeof(*c->sorted), cmp_key);
+}
+
+bool counter_next(counter *c, size_t *pos, counter_cell *cell) {
+    size_t i = *pos;
+    uint32_t key, count;
+    if (c->cells) {
+        size_t cells = c->w * c->h;
+        while (i < cells && c->cells[i] == 0) { i++; }
+        if (i == cells) { return false; }
+        key = i;
+        count = c->cells[i];
+    } else {
+        if (i == 0) { sort_used(c); }
+        if (i == c->used) { return false; }
+        key = c->sorted[i].key;
+        count = c->sorted[i].count;
+    }
+
+    cell->x = key % c->w;
+    cell->y = key / c->w;
+    cell->count = count;
+    *pos = i + 1;
+    return true;
+}
+
+void counter_get_stats(counter *c, counter_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (c->cells) {
+        stats->capacity = c->w * c->h;
+        for (size_t i = 0; i < stats->capacity; i++) {
+            if (c->cells[i] > 0) { stats->used++; }
+        }
+    } else {
+        stats->capacity = c->bucket_count;
+        stats->used = c->used;
+        stats->max_probe = c->max_probe;
+
+        size_t total = 0;
+        for (size_t i = 0; i < c->bucket_count; i++) {
+            uint32_t key = c->buckets[i].key;
+            if (key != EMPTY_KEY) { total += probe_distance(c, key, i); }
+        }
+        if (c->used > 0) { stats->mean_probe = (double)total / c->used; }
+    }
+    stats->load = (double)stats->used / stats->capacity;
 }
 
 void counter_free(counter *c) {
-    free(c);
+    if (c) {
+        free(c->cells);
+        free(c->buckets);
+        free(c->sorted);
+        free(c);
+    }
 }
@@ -5,13 +5,50 @@
 
 typedef struct counter counter;
 
-/* Init a counter table with sufficient space for ROWS cells. */
-counter *counter_init(size_t rows);
+typedef struct {
+    size_t used;                /* cells with a nonzero count */
+    size_t capacity;            /* cells in the grid, or hash buckets */
+    double load;                /* used / capacity */
+    size_t max_probe;           /* longest hash probe sequence */
+    double mean_probe;
+} counter_stats;
 
+/* Init a counter for a W x H plot of up to ROWS points. Returns NULL
+ * (with errno set) if it can't be allocated, or the plot is too
+ * large to count. */
+counter *counter_init(size_t w, size_t h, size_t rows);
+
+/* Clear C for reuse for a W x H plot of up to ROWS points,
+ * reallocating it if it doesn't fit. C may be NULL. */
+counter *counter_reset(counter *c, size_t w, size_t h, size_t rows);
+
+/* Count a point at (X, Y). Points outside the plot are ignored. */
 void counter_increment(counter *c, size_t x, size_t y);
 
+/* Add SRC's counts to DST's, for combining counts taken separately
+ * (say, on different threads). Both must be for the same size plot,
+ * but either may be dense or sparse. */
+void counter_merge(counter *dst, const counter *src);
+
+/* Get the count at (X, Y), or 0 if it's outside the plot. */
 size_t counter_get(counter *c, size_t x, size_t y);
 
+typedef struct {
+    size_t x;
+    size_t y;
+    size_t count;
+} counter_cell;
+
+/* Step through C's cells with nonzero counts, in row-major order, so
+ * the cost depends on how many pixels are occupied rather than how
+ * many points were counted. Set *POS to 0 before the first call; each
+ * call sets *CELL and returns true, until there are no more cells.
+ * C must not be changed until the iteration is done. */
+bool counter_next(counter *c, size_t *pos, counter_cell *cell);
+
+/* Get C's occupancy and (if it's a hash table) probe lengths. */
+void counter_get_stats(counter *c, counter_stats *stats);
+
 void counter_free(counter *c);
 
 #endif
@@ -7,12 +7,14 @@
 #include "ascii.h"
 #include "svg.h"
 #include "counter.h"
+#include "bounds.h"
+#include "parallel.h"
 
 /* Common drawing functionality. */
 
-static void count_points(counter *counter, plot_info *pi, data_set *ds, uint8_t column);
 static bool all_empty_points(plot_info *pi);
 static bool insufficient_range(plot_info *pi);
+static void set_bounds(plot_info *pi, point *min_p, point *max_p);
 
 static const double MAX = 1e100;  // TODO: portable constants? DBL_MAX?
 static const double MIN = -1e100;
@@ -23,6 +25,21 @@ int draw(config *cfg, data_set *ds) {
 
     pi.log_x = cfg->log_x;
     pi.log_y = cfg->log_y;
+    pi.pin_x = cfg->pin_x;
+    pi.pin_y = cfg->pin_y;
+    // SVG lines leaving the plot are cut off by the canvas instead, but
+    // ASCII draws line mode as points, which must stay on the grid
+    pi.clip = (pi.pin_x.pinned || pi.pin_y.pinned)
+        && (cfg->mode != MODE_LINE || cfg->plot_type == PLOT_ASCII);
+
+    // log-scale everything once, for bounds, counting, and plotting
+    data_set transformed;
+    transform_t t = scale_get_transform(pi.log_x, pi.log_y);
+    if (t != TRANSFORM_NONE) {
+        scale_transform_data_set(&cfg->transform_cache, ds, t, &transformed);
+        ds = &transformed;
+        pi.pretransformed = true;
+    }
 
     draw_calc_bounds(ds, &pi);
 
@@ -32,15 +49,8 @@ int draw(config *cfg, data_set *ds) {
     pi.w = cfg->width;
     pi.h = cfg->height;
 
-    if (cfg->mode == MODE_COUNT) {
-        pi.counters = calloc(ds->columns, sizeof(counter *));
-        assert(pi.counters);
-        for (uint8_t c = 0; c < ds->columns; c++) {
-            counter *counter = counter_init(ds->rows);
-            assert(counter);
-            count_points(counter, &pi, ds, c);
-            pi.counters[c] = counter;
-        }
+    if (cfg->mode == MODE_COUNT || cfg->mode == MODE_HEAT || cfg->mode == MODE_HEX) {
+        draw_count(cfg, &pi, ds);
     }
     
     int res = 0;
@@ -58,14 +68,24 @@ int draw(config *cfg, data_set *ds) {
         assert(false);
         break;
     }
+    return res;
+}
 
-    if (pi.counters) {
-        for (uint8_t c = 0; c < ds->columns; c++) {
-            counter_free(pi.counters[c]);
-        }
-        free(pi.counters);
+void draw_close(config *cfg) {
+    for (uint8_t c = 0; c < cfg->counter_count; c++) {
+        counter_free(cfg->counters[c]);
     }
-    return res;
+    free(cfg->counters);
+    cfg->counters = NULL;
+    cfg->counter_count = 0;
+    for (size_t i = 0; i < cfg->partial_counter_count; i++) {
+        counter_free(cfg->partial_counters[i]);
+    }
+    free(cfg->partial_counters);
+    cfg->partial_counters = NULL;
+    cfg->partial_counter_count = 0;
+    scale_free_transform_cache(cfg->transform_cache);
+    cfg->transform_cache = NULL;
 }
 
 static bool all_empty_points(plot_info *pi) {
@@ -76,45 +96,95 @@ static bool insufficient_range(plot_info *pi) {
     return (pi->range_x == 0) || (pi->range_y == 0);
 }
 
-void draw_calc_bounds(data_set *ds, plot_info *pi) {
-    point min_p = { .x = MAX, .y = MAX };
-    point max_p = { .x = MIN, .y = MIN };
-
+/* Exit with an error for the first point that can't be log-scaled, in
+ * the order the points are plotted, or else for MIN_P. */
+static void log_domain_error(data_set *ds, transform_t t, point *min_p) {
     for (uint8_t c = 0; c < ds->columns; c++) {
+        const double *xs = DS_XS(ds, c);
+        const double *ys = DS_YS(ds, c);
         for (size_t r = 0; r < ds->rows; r++) {
-            point *p = &ds->pairs[c][r];
-
-            if (IS_EMPTY_POINT(p)) { continue; }
+            double x = xs[r];
+            double y = ys[r];
+            if (IS_EMPTY(x) || IS_EMPTY(y)) { continue; }
 
-            if (pi->log_x && p->x <= 0) {
-                fprintf(stderr, "floating point error: log(%g)\n", p->x);
+            if ((t & TRANSFORM_LOG_X) && x <= 0) {
+                fprintf(stderr, "floating point error: log(%g)\n", x);
                 exit(1);
             }
-            if (pi->log_y && p->y <= 0) {
-                fprintf(stderr, "floating point error: log(%g)\n", p->y);
+            if ((t & TRANSFORM_LOG_Y) && y <= 0) {
+                fprintf(stderr, "floating point error: log(%g)\n", y);
                 exit(1);
             }
+        }
+    }
+    double v = ((t & TRANSFORM_LOG_X) && min_p->x <= 0 ? min_p->x : min_p->y);
+    fprintf(stderr, "floating point error: log(%g)\n", v);
+    exit(1);
+}
 
-            double x = p->x;
-            double y = p->y;
-
-            if (x < min_p.x) { min_p.x = x; }
-            if (x > max_p.x) { max_p.x = x; }
-
-            if (y < min_p.y) { min_p.y = y; }
-            if (y > max_p.y) { max_p.y = y; }
+void draw_calc_bounds(data_set *ds, plot_info *pi) {
+    point min_p = { .x = MAX, .y = MAX };
+    point max_p = { .x = MIN, .y = MIN };
+    transform_t t = scale_get_plot_transform(pi);
+
+    if (ds->has_bounds) {
+        min_p = ds->min;
+        max_p = ds->max;
+        if (ds->flip_xy) {
+            min_p = (point){ .x = ds->min.y, .y = ds->min.x };
+            max_p = (point){ .x = ds->max.y, .y = ds->max.x };
         }
+    } else {
+        bounds_scan(ds, &min_p, &max_p);
+    }
+
+    if (((t & TRANSFORM_LOG_X) && min_p.x <= 0)
+        || ((t & TRANSFORM_LOG_Y) && min_p.y <= 0)) {
+        log_domain_error(ds, t, &min_p);
     }
 
-    transform_t t = scale_get_transform(pi->log_x, pi->log_y);
     point out_min_p, out_max_p;
     scale_transform(&min_p, t, &out_min_p);
     scale_transform(&max_p, t, &out_max_p);
-    
-    pi->min_x = out_min_p.x;
-    pi->min_y = out_min_p.y;
-    pi->max_x = out_max_p.x;
-    pi->max_y = out_max_p.y;
+    set_bounds(pi, &out_min_p, &out_max_p);
+}
+
+void draw_calc_pinned_bounds(plot_info *pi) {
+    assert(pi->pin_x.pinned && pi->pin_y.pinned);
+    point min_p = { .x = 0, .y = 0 };
+    point max_p = { .x = 0, .y = 0 };
+    set_bounds(pi, &min_p, &max_p);     // both replaced by the pins
+}
+
+/* Replace the bounds of any pinned axes with their pinned bounds,
+ * log-scaled along with the axis. The pins are always in data space,
+ * even when the points have been transformed already. */
+static void apply_pins(plot_info *pi, point *min_p, point *max_p) {
+    transform_t t = scale_get_transform(pi->log_x, pi->log_y);
+    point pin_min = { .x = pi->pin_x.min, .y = pi->pin_y.min };
+    point pin_max = { .x = pi->pin_x.max, .y = pi->pin_y.max };
+    point out_min, out_max;
+    scale_transform(&pin_min, t, &out_min);
+    scale_transform(&pin_max, t, &out_max);
+
+    if (pi->pin_x.pinned) {
+        min_p->x = out_min.x;
+        max_p->x = out_max.x;
+    }
+    if (pi->pin_y.pinned) {
+        min_p->y = out_min.y;
+        max_p->y = out_max.y;
+    }
+}
+
+/* Set PI's bounds from the (transformed) bounds of its points. */
+static void set_bounds(plot_info *pi, point *min_p, point *max_p) {
+    apply_pins(pi, min_p, max_p);
+
+    pi->min_x = min_p->x;
+    pi->min_y = min_p->y;
+    pi->max_x = max_p->x;
+    pi->max_y = max_p->y;
 
     /* Override bounds that would lead to a range of zero, to avoid a
      * crash when plotting. (Found by afl.) */
@@ -129,7 +199,8 @@ void draw_calc_bounds(data_set *ds, plot_info *pi) {
     
     double cross_pad = CROSS_PAD;
 
-    if (!crosses_x) {
+    // pinned bounds are used as given, without stretching to the axes
+    if (!crosses_x && !pi->pin_x.pinned) {
         if (0 < pi->min_x && 0 > pi->min_x - pi->range_x*cross_pad) {
             pi->min_x = 0;
             pi->range_x = pi->max_x;
@@ -139,7 +210,7 @@ void draw_calc_bounds(data_set *ds, plot_info *pi) {
         }
     }
 
-    if (!crosses_y) {
+    if (!crosses_y && !pi->pin_y.pinned) {
         if (0 < pi->min_y && 0 > pi->min_y - pi->range_y*cross_pad) {
             pi->min_y = 0;
             pi->range_y = pi->max_y;
@@ -181,16 +252,136 @@ void draw_calc_axis_pos(plot_info *pi) {
     LOG(1, "axis at: (%g, %g) scaled to (%d, %d)\n", origin.x, origin.y, sp.x, sp.y);
 }
 
-static void count_points(counter *counter, plot_info *pi, data_set *ds, uint8_t column) {
-    point *points = ds->pairs[column];
-    transform_t t = scale_get_transform(pi->log_x, pi->log_y);
+/* Count the points in rows [FROM, TO) of DS's COLUMN. */
+static void count_rows(counter *counter, plot_info *pi, data_set *ds,
+        uint8_t column, size_t from, size_t to) {
+    const double *xs = DS_XS(ds, column);
+    const double *ys = DS_YS(ds, column);
+    transform_t t = scale_get_plot_transform(pi);
+    scaled_point sps[SCALE_BLOCK];
+
+    for (size_t r = from; r < to; r += SCALE_BLOCK) {
+        size_t count = to - r;
+        if (count > SCALE_BLOCK) { count = SCALE_BLOCK; }
+        scale_points(pi, &xs[r], &ys[r], count, t, sps);
+
+        for (size_t i = 0; i < count; i++) {
+            if (sps[i].x == SCALED_EMPTY) { continue; }
+            counter_increment(counter, sps[i].x, sps[i].y);
+        }
+    }
+}
+
+void draw_count_points(counter *counter, plot_info *pi, data_set *ds, uint8_t column) {
+    count_rows(counter, pi, ds, column, 0, ds->rows);
+}
+
+/* Frames with at least this many points are counted in parallel, and
+ * each task counts at least PARALLEL_MIN_POINTS / 2 of them. */
+#define PARALLEL_MIN_POINTS (1024 * 1024)
+
+/* Counting is split into tasks by column, and then each column's rows
+ * are split into PARTS blocks. Each column's first block is counted
+ * straight into its counter, and the others into partial counters,
+ * which are merged in afterward. */
+struct count_task {
+    config *cfg;
+    plot_info *pi;
+    data_set *ds;
+    size_t parts;
+};
+
+static counter *task_counter(struct count_task *t, uint8_t column, size_t part) {
+    if (part == 0) { return t->cfg->counters[column]; }
+    return t->cfg->partial_counters[column * (t->parts - 1) + part - 1];
+}
+
+static void count_task(size_t i, void *udata) {
+    struct count_task *t = udata;
+    uint8_t column = i / t->parts;
+    size_t part = i % t->parts;
+    size_t rows = t->ds->rows;
+    size_t from = part * (rows / t->parts);
+    size_t to = (part == t->parts - 1 ? rows : from + rows / t->parts);
+    count_rows(task_counter(t, column, part), t->pi, t->ds, column, from, to);
+}
+
+static void merge_task(size_t column, void *udata) {
+    struct count_task *t = udata;
+    counter *counter = task_counter(t, column, 0);
+    for (size_t part = 1; part < t->parts; part++) {
+        counter_merge(counter, task_counter(t, column, part));
+    }
+}
+
+/* Grow an array of counters kept in CFG to COUNT, with new ones NULL. */
+static counter **reserve_counters(counter **counters, size_t *have, size_t count) {
+    if (count <= *have) { return counters; }
+    counter **ncounters = realloc(counters, count * sizeof(counter *));
+    if (ncounters == NULL) { err(1, "realloc"); }
+    for (size_t i = *have; i < count; i++) { ncounters[i] = NULL; }
+    *have = count;
+    return ncounters;
+}
+
+void draw_count(config *cfg, plot_info *pi, data_set *ds) {
+    size_t have = cfg->counter_count;
+    cfg->counters = reserve_counters(cfg->counters, &have, ds->columns);
+    cfg->counter_count = have;
+
+    size_t points = ds->rows * ds->columns;
+    size_t tasks = points / (PARALLEL_MIN_POINTS / 2);
+    if (tasks > parallel_threads()) { tasks = parallel_threads(); }
+
+    /* Split each column's rows if there's enough work for that, or
+     * else only count columns in parallel if each is large enough.
+     * Otherwise, starting threads costs more than it saves. */
+    bool parallel = false;
+    size_t parts = 1;
+    if (points >= PARALLEL_MIN_POINTS && tasks > 1) {
+        if (tasks >= ds->columns) {
+            parts = tasks / ds->columns;
+            parallel = true;
+        } else {
+            parallel = (ds->rows >= PARALLEL_MIN_POINTS / 2);
+        }
+    }
+
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        counter *counter = counter_reset(cfg->counters[c], pi->w, pi->h, ds->rows);
+        if (counter == NULL) { err(1, "counter_reset"); }
+        cfg->counters[c] = counter;
+    }
+
+    size_t partials = ds->columns * (parts - 1);
+    cfg->partial_counters = reserve_counters(cfg->partial_counters,
+        &cfg->partial_counter_count, partials);
+    for (size_t i = 0; i < partials; i++) {
+        counter *counter = counter_reset(cfg->partial_counters[i],
+            pi->w, pi->h, ds->rows / parts);
+        if (counter == NULL) { err(1, "counter_reset"); }
+        cfg->partial_counters[i] = counter;
+    }
 
-    for (size_t r = 0; r < ds->rows; r++) {
-        point *p = &points[r];
-        if (IS_EMPTY(p->x) || IS_EMPTY(p->y)) { continue; }
-        scaled_point sp;
-        scale_point(pi, p, &sp, t);
+    if (parallel) {
+        struct count_task t = { .cfg = cfg, .pi = pi, .ds = ds, .parts = parts };
+        LOG(1, "counting %zu points in %zu tasks\n", points, ds->columns * parts);
+        parallel_run(ds->columns * parts, count_task, &t);
+        if (parts > 1) { parallel_run(ds->columns, merge_task, &t); }
+    } else {
+        for (uint8_t c = 0; c < ds->columns; c++) {
+            count_rows(cfg->counters[c], pi, ds, c, 0, ds->rows);
+        }
+    }
 
-        counter_increment(counter, sp.x, sp.y);
+#ifdef DEBUG
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        counter_stats stats;
+        counter_get_stats(cfg->counters[c], &stats);
+        LOG(1, "counter %u: %zu/%zu used (%.2f), probe max %zu, mean %.2f\n",
+            c, stats.used, stats.capacity, stats.load,
+            stats.max_probe, stats.mean_probe);
     }
+#endif
+    pi->counters = cfg->counters;
 }
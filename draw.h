@@ -14,6 +14,10 @@ typedef struct {
 
     bool log_x;
     bool log_y;
+    bool pretransformed;        // the data_set's values are already log-scaled
+    axis_pin pin_x;             // bounds from -X and -Y, in data space
+    axis_pin pin_y;
+    bool clip;                  // skip points outside the (pinned) bounds
     size_t w;
     size_t h;
 
@@ -28,8 +32,22 @@ typedef struct {
 } plot_info;
 
 int draw(config *cfg, data_set *ds);
+
+/* Release anything kept between frames for drawing. */
+void draw_close(config *cfg);
 void draw_scale_point(plot_info *pi, point *p, size_t *out_x, size_t *out_y);
 void draw_calc_bounds(data_set *ds, plot_info *pi);
+
+/* Set up PI's bounds from its pinned bounds alone, before any points
+ * have been read. Both axes must be pinned. */
+void draw_calc_pinned_bounds(plot_info *pi);
+
+/* Count each of DS's columns' points by pixel, into cfg->counters, and
+ * point pi->counters at them. Large frames are counted in parallel. */
+void draw_count(config *cfg, plot_info *pi, data_set *ds);
+
+/* Count the points in DS's COLUMN into COUNTER, by pixel. */
+void draw_count_points(struct counter *counter, plot_info *pi, data_set *ds, uint8_t column);
 void draw_calc_axis_pos(plot_info *pi);
 
 #endif
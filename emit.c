@@ -0,0 +1,109 @@
+#include "emit.h"
+
+/* Buffered output. */
+
+#define EMIT_BUF_SIZE (64 * 1024)
+
+/* Room for the longest number, so they can be formatted in place. */
+#define EMIT_MAX_NUMBER 32
+
+static char buf[EMIT_BUF_SIZE];
+static size_t used = 0;
+
+void emit_flush(void) {
+    if (used > 0) {
+        if (fwrite(buf, 1, used, stdout) != used) { err(1, "fwrite"); }
+        used = 0;
+    }
+    fflush(stdout);
+}
+
+static char *reserve(size_t size) {
+    if (used + size > EMIT_BUF_SIZE) { emit_flush(); }
+    return &buf[used];
+}
+
+void emit_str(const char *s) {
+    size_t len = strlen(s);
+    while (len > 0) {
+        if (used == EMIT_BUF_SIZE) { emit_flush(); }
+        size_t n = EMIT_BUF_SIZE - used;
+        if (n > len) { n = len; }
+        memcpy(&buf[used], s, n);
+        used += n;
+        s += n;
+        len -= n;
+    }
+}
+
+/* Write V's digits to the end of the space before P, and return a
+ * pointer to the first. */
+static char *format_digits(char *p, uint64_t v) {
+    do {
+        *--p = '0' + (v % 10);
+        v /= 10;
+    } while (v > 0);
+    return p;
+}
+
+static void emit_digits(uint64_t v, bool negative) {
+    char tmp[EMIT_MAX_NUMBER];
+    char *end = &tmp[sizeof(tmp)];
+    char *p = format_digits(end, v);
+    if (negative) { *--p = '-'; }
+    size_t len = end - p;
+    memcpy(reserve(len), p, len);
+    used += len;
+}
+
+void emit_uint(size_t v) {
+    emit_digits(v, false);
+}
+
+void emit_int(int64_t v) {
+    if (v < 0) {
+        emit_digits(-(uint64_t)v, true);
+    } else {
+        emit_digits(v, false);
+    }
+}
+
+/* Past this, MAG * 10 may be rounded too far to tell if it was
+ * near halfway. */
+#define FIXED_MAX 1e8
+
+void emit_fixed1(double v) {
+    double mag = fabs(v);
+    double tenths = mag * 10;
+    double rounded = floor(tenths + 0.5);
+
+    /* printf rounds the exact binary value, which can differ from
+     * rounding MAG * 10 when it's within an ulp or so of halfway. Those
+     * (and NaN, infinities, and huge values) are rare enough to leave
+     * to snprintf. */
+    if (!(mag < FIXED_MAX) || fabs(tenths - floor(tenths) - 0.5) < 1e-6) {
+        char *p = reserve(EMIT_MAX_NUMBER);
+        int len = snprintf(p, EMIT_MAX_NUMBER, "%.1f", v);
+        if (len >= EMIT_MAX_NUMBER) {
+            // only possible for huge values, so take the slow path
+            char tmp[400];
+            snprintf(tmp, sizeof(tmp), "%.1f", v);
+            emit_str(tmp);
+        } else {
+            used += len;
+        }
+        return;
+    }
+
+    uint64_t t = (uint64_t)rounded;
+    char tmp[EMIT_MAX_NUMBER];
+    char *end = &tmp[sizeof(tmp)];
+    char *p = end;
+    *--p = '0' + (t % 10);
+    *--p = '.';
+    p = format_digits(p, t / 10);
+    if (signbit(v)) { *--p = '-'; }
+    size_t len = end - p;
+    memcpy(reserve(len), p, len);
+    used += len;
+}
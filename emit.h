@@ -0,0 +1,23 @@
+#ifndef EMIT_H
+#define EMIT_H
+
+#include "guff.h"
+
+/* Buffered output, for SVG. Numbers are formatted by hand into one
+ * large buffer, which is written to stdout in big chunks, rather than
+ * going through printf's format parsing and stdio locking per call.
+ * The bytes are the same as printf's. */
+
+/* Append a string. */
+void emit_str(const char *s);
+
+/* Append a number, like printf's "%zu" / "%d" / "%.1f". */
+void emit_uint(size_t v);
+void emit_int(int64_t v);
+void emit_fixed1(double v);
+
+/* Write out anything buffered. This must be called before anything
+ * else writes to stdout. */
+void emit_flush(void);
+
+#endif
@@ -31,6 +31,10 @@
 #define IS_EMPTY(V) isnan(V)
 #define IS_EMPTY_POINT(P) (IS_EMPTY(P->x) || IS_EMPTY(P->y))
 
+/* The X and Y values plotted for a data_set's column. */
+#define DS_XS(DS, C) ((DS)->flip_xy ? (DS)->ys[C] : (DS)->xs)
+#define DS_YS(DS, C) ((DS)->flip_xy ? (DS)->xs : (DS)->ys[C])
+
 #ifdef DEBUG
 #define LOG(LVL, ...)                                                  \
     do {                                                               \
@@ -0,0 +1,92 @@
+#include "hexbin.h"
+#include "counter.h"
+
+/* Hexagonal binning. */
+
+/* Pixel and hex center coordinates are all doubled, so the centers of
+ * pixels ((2x + 1, 2y + 1)) and of shifted rows' hexes (an odd multiple
+ * of the hex's width) are integers, and comparisons are exact. */
+
+void hexbin_init(hex_grid *g, size_t w, size_t h, size_t width) {
+    if (width < 2) { width = 2; }
+    // for regular hexagons, rows are sqrt(3)/2 as far apart as columns
+    size_t row_height = (size_t)(width * 0.8660254037844386 + 0.5);
+    size_t cols = w / width + 2;
+    size_t rows = h / row_height + 2;
+
+    if (cols * rows > g->cols * g->rows || g->counts == NULL) {
+        uint64_t *ncounts = realloc(g->counts, cols * rows * sizeof(*ncounts));
+        if (ncounts == NULL) { err(1, "realloc"); }
+        g->counts = ncounts;
+    }
+    memset(g->counts, 0, cols * rows * sizeof(*g->counts));
+    g->width = width;
+    g->row_height = row_height;
+    g->cols = cols;
+    g->rows = rows;
+    g->max = 0;
+}
+
+/* The nearest hex to doubled pixel coordinates (X2, Y2) in ROW, and
+ * its squared distance (still doubled). */
+static uint64_t nearest_in_row(const hex_grid *g, int64_t x2, int64_t y2,
+        size_t row, size_t *col) {
+    int64_t w = g->width;
+    int64_t shift = (row & 1 ? w : 0);
+    int64_t c = (x2 - shift + w) / (2 * w);  // numerator is positive
+    int64_t dx = x2 - (2 * w * c + shift);
+    int64_t dy = y2 - 2 * (int64_t)(g->row_height * row);
+    *col = c;
+    return dx * dx + dy * dy;
+}
+
+void hexbin_cell(const hex_grid *g, size_t x, size_t y, size_t *col, size_t *row) {
+    int64_t x2 = 2 * (int64_t)x + 1;
+    int64_t y2 = 2 * (int64_t)y + 1;
+    size_t above = y / g->row_height;   // the row at or above the pixel
+
+    /* Since rows are more than half a hex's width apart, the nearest
+     * center is always in one of the two rows around the pixel. */
+    size_t col_a, col_b;
+    uint64_t dist_a = nearest_in_row(g, x2, y2, above, &col_a);
+    uint64_t dist_b = nearest_in_row(g, x2, y2, above + 1, &col_b);
+    bool below = dist_b < dist_a;
+    *col = (below ? col_b : col_a);
+    *row = above + below;
+}
+
+void hexbin_count(hex_grid *g, plot_info *pi, uint8_t columns) {
+    for (uint8_t c = 0; c < columns; c++) {
+        size_t pos = 0;
+        counter_cell cell;
+        while (counter_next(pi->counters[c], &pos, &cell)) {
+            size_t col, row;
+            hexbin_cell(g, cell.x, cell.y, &col, &row);
+            uint64_t *count = &g->counts[row * g->cols + col];
+            *count += cell.count;
+            if (*count > g->max) { g->max = *count; }
+        }
+    }
+}
+
+void hexbin_center(const hex_grid *g, size_t col, size_t row, double *x, double *y) {
+    *x = col * g->width + (row & 1 ? g->width / 2.0 : 0);
+    *y = row * g->row_height;
+}
+
+void hexbin_corners(const hex_grid *g, double *half_w, double *top, double *side) {
+    /* The corners are where the perpendicular bisectors toward the
+     * neighboring centers meet: the ones at (w, 0) and (w/2, h). */
+    double hw = g->width / 2.0;
+    double h = g->row_height;
+    *half_w = hw;
+    *top = (h * h + hw * hw) / (2 * h);
+    *side = (h * h - hw * hw) / (2 * h);
+}
+
+void hexbin_free(hex_grid *g) {
+    free(g->counts);
+    g->counts = NULL;
+    g->cols = 0;
+    g->rows = 0;
+}
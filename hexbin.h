@@ -0,0 +1,41 @@
+#ifndef HEXBIN_H
+#define HEXBIN_H
+
+#include "guff.h"
+#include "draw.h"
+
+/* Hexagonal binning, for hex mode. Pixels are grouped into rows of
+ * pointy-topped hexagons, with every other row shifted half a hex to
+ * the right. Each pixel goes to the hex with the nearest center, found
+ * with integer arithmetic from the two rows on either side of it. */
+
+typedef struct {
+    size_t width;               /* hex width (flat side to flat side) */
+    size_t row_height;          /* distance between rows' centers */
+    size_t cols;
+    size_t rows;
+    uint64_t *counts;           /* counts[row * cols + col] */
+    uint64_t max;               /* largest count */
+} hex_grid;
+
+/* Set up G for a W x H plot, with hexes WIDTH pixels across. Any
+ * storage G already has is reused if it's large enough. */
+void hexbin_init(hex_grid *g, size_t w, size_t h, size_t width);
+
+/* Find the hex containing pixel (X, Y). */
+void hexbin_cell(const hex_grid *g, size_t x, size_t y, size_t *col, size_t *row);
+
+/* Sum the first COLUMNS of PI's counters into G's hexes. Only occupied
+ * pixels are visited, so this doesn't depend on the number of points. */
+void hexbin_count(hex_grid *g, plot_info *pi, uint8_t columns);
+
+/* Get the center of a hex, in pixels. */
+void hexbin_center(const hex_grid *g, size_t col, size_t row, double *x, double *y);
+
+/* Get the offsets from a hex's center to its top corner (0, -*TOP)
+ * and upper right corner (*HALF_W, -*SIDE); the rest are mirrored. */
+void hexbin_corners(const hex_grid *g, double *half_w, double *top, double *side);
+
+void hexbin_free(hex_grid *g);
+
+#endif
@@ -1,29 +1,66 @@
+#define _POSIX_C_SOURCE 200809L
 #include "input.h"
 #include "input_internal.h"
+#include "parse.h"
+#include "scan.h"
+#include "parallel.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /* Input handling. */
 
-static void add_pair(config *cfg, data_set *ds, size_t row, uint8_t col, point *p);
+static struct input_map *map_input(config *cfg);
+static bool read_parallel(config *cfg, struct input_map *map, data_set *ds, int *res);
+static char *next_line(config *cfg, size_t *len);
+static void reserve(data_set *ds, size_t rows, size_t columns);
+static void add_value(data_set *ds, size_t row, uint8_t col, double x, double y);
 static bool number_head_char(char c);
 
 static char buf[64 * 1024];
 
+/* When the input is a regular file, it is mmap'd and the parser walks
+ * the mapping in place, rather than copying each line into buf. */
+struct input_map {
+    bool mapped;
+    char *base;
+    size_t size;
+    size_t offset;
+    struct chunk *chunks;       /* for read_parallel, reused across frames */
+    size_t chunk_count;
+};
+
+/* Mapped frames at least this large are split into chunks and parsed
+ * in parallel, with each thread getting at least PARALLEL_MIN_CHUNK. */
+#define PARALLEL_MIN_FRAME (4 * 1024 * 1024)
+#define PARALLEL_MIN_CHUNK (1024 * 1024)
+
+#define MIN_ROW_CEIL2 1
+
 int input_read(config *cfg, data_set *ds) {
     char *line = NULL;
+    size_t len = 0;
     
     size_t row_count = 0;
 
-    init_pairs(ds);
+    struct input_map *map = map_input(cfg);
+    if (map->mapped && cfg->batch_rows == 0 && parallel_threads() > 1) {
+        int res = 0;
+        if (read_parallel(cfg, map, ds, &res)) { return res; }
+    }
+
+    init_columns(ds);
 
-    while ((line = fgets(buf, sizeof(buf) - 1, cfg->in))) {
-        size_t len = strlen(line);
-        
+    while ((line = next_line(cfg, &len))) {
         sink_line_res res = sink_line(cfg, ds, line, len, row_count);
         switch (res) {
         case SINK_LINE_OK:
             row_count++;
+            // in window and raster modes, rows are handed off in batches
+            if (row_count == cfg->batch_rows) { return INPUT_BATCH; }
             break;
         case SINK_LINE_EMPTY:
+            if (cfg->window_size > 0) { continue; }
             return (cfg->stream_mode ? 0 : -1);
         case SINK_LINE_COMMENT:
             continue;
@@ -38,6 +75,236 @@ int input_read(config *cfg, data_set *ds) {
     return -1;  // end of stream
 }
 
+static struct input_map *map_input(config *cfg) {
+    if (cfg->in_map) { return cfg->in_map; }
+
+    struct input_map *map = calloc(1, sizeof(*map));
+    if (map == NULL) { err(1, "calloc"); }
+    cfg->in_map = map;
+
+    int fd = fileno(cfg->in);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1) { return map; }
+    if (!S_ISREG(st.st_mode)) { return map; }
+
+    long start = ftell(cfg->in);
+    if (start < 0 || start >= st.st_size) { return map; }
+
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) { return map; }  // fall back on stdio
+    posix_madvise(base, st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    map->mapped = true;
+    map->base = base;
+    map->size = st.st_size;
+    map->offset = start;
+    LOG(1, "mapped input: %zu bytes\n", map->size);
+    return map;
+}
+
+/* Get the next line (including its '\n', if any) and its length,
+ * or NULL at end of stream. */
+static char *next_line(config *cfg, size_t *len) {
+    struct input_map *map = map_input(cfg);
+
+    if (!map->mapped) {
+        char *line = fgets(buf, sizeof(buf) - 1, cfg->in);
+        if (line) { *len = strlen(line); }
+        return line;
+    }
+
+    if (map->offset >= map->size) { return NULL; }
+
+    /* The last line may not have a trailing newline; sink_line
+     * never reads past len, so it can still be used in place. */
+    char *line = &map->base[map->offset];
+    const char *end = &map->base[map->size];
+    const char *nl = scan_newline(line, end);
+    *len = (nl < end ? (size_t)(nl - line) + 1 : (size_t)(end - line));
+    map->offset += *len;
+    return line;
+}
+
+/* Find the start of the first blank line, which ends the frame. */
+static const char *find_blank_line(const char *p, const char *end) {
+    while (p < end) {
+        if (*p == '\n' || *p == '\0') { return p; }
+        const char *nl = scan_newline(p, end);
+        if (nl == end) { break; }
+        p = nl + 1;
+    }
+    return end;
+}
+
+struct chunk {
+    config *cfg;
+    const char *start;
+    const char *end;
+    size_t rows;                /* rows numbered, starting from 0 */
+    data_set ds;
+};
+
+static void parse_chunk(size_t i, void *udata) {
+    struct chunk *ch = &((struct chunk *)udata)[i];
+    init_columns(&ch->ds);
+
+    const char *p = ch->start;
+    while (p < ch->end) {
+        const char *nl = scan_newline(p, ch->end);
+        size_t len = (nl < ch->end ? nl + 1 : ch->end) - p;
+        if (SINK_LINE_OK == sink_line(ch->cfg, &ch->ds, p, len, ch->rows)) {
+            ch->rows++;
+        }
+        p += len;
+    }
+}
+
+/* Does ROW have a complete point, in any column? */
+static bool complete_row(const data_set *ds, size_t row) {
+    if (IS_EMPTY(ds->xs[row])) { return false; }
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        if (!IS_EMPTY(ds->ys[c][row])) { return true; }
+    }
+    return false;
+}
+
+/* Combine the bounds each chunk found while parsing. In row-count mode
+ * the chunks' X values were renumbered, but since they increase with
+ * the row, the X bounds are just those of the first and last complete
+ * rows, which are usually right at the ends. */
+static void stitch_bounds(config *cfg, struct chunk *chunks, size_t count, data_set *ds) {
+    for (size_t i = 0; i < count; i++) {
+        const data_set *cds = &chunks[i].ds;
+        if (!cds->has_bounds) { continue; }
+        ds->has_bounds = true;
+        if (cds->min.y < ds->min.y) { ds->min.y = cds->min.y; }
+        if (cds->max.y > ds->max.y) { ds->max.y = cds->max.y; }
+        if (cfg->x_column) {
+            if (cds->min.x < ds->min.x) { ds->min.x = cds->min.x; }
+            if (cds->max.x > ds->max.x) { ds->max.x = cds->max.x; }
+        }
+    }
+
+    if (ds->has_bounds && !cfg->x_column) {
+        size_t first = 0;
+        while (!complete_row(ds, first)) { first++; }
+        size_t last = ds->rows - 1;
+        while (!complete_row(ds, last)) { last--; }
+        ds->min.x = ds->xs[first];
+        ds->max.x = ds->xs[last];
+    }
+}
+
+/* Concatenate the chunks' columns, in order, into DS. Each chunk
+ * numbered its rows from 0, so in row-count mode the X values are
+ * renumbered exactly as the serial path would have. */
+static void stitch_chunks(config *cfg, struct chunk *chunks, size_t count, data_set *ds) {
+    size_t rows = 0;
+    uint8_t columns = 1;
+    for (size_t i = 0; i < count; i++) {
+        rows += chunks[i].rows;
+        if (chunks[i].ds.columns > columns) { columns = chunks[i].ds.columns; }
+    }
+
+    init_columns(ds);
+    reserve(ds, rows, columns);
+    double *xs = ds->xs;
+    double **ys = ds->ys;
+
+    size_t base = 0;
+    for (size_t i = 0; i < count; i++) {
+        struct chunk *ch = &chunks[i];
+        size_t have = ch->ds.rows;
+
+        if (cfg->x_column) {
+            memcpy(&xs[base], ch->ds.xs, have * sizeof(*xs));
+            for (size_t r = have; r < ch->rows; r++) { xs[base + r] = EMPTY_VALUE; }
+        } else {
+            for (size_t r = 0; r < ch->rows; r++) { xs[base + r] = (float)(base + r); }
+        }
+
+        for (uint8_t c = 0; c < columns; c++) {
+            double *dst = &ys[c][base];
+            size_t col_have = (c < ch->ds.columns ? have : 0);
+            memcpy(dst, ch->ds.ys[c < ch->ds.columns ? c : 0], col_have * sizeof(*dst));
+            for (size_t r = col_have; r < ch->rows; r++) { dst[r] = EMPTY_VALUE; }
+        }
+        base += ch->rows;
+    }
+
+    ds->columns = columns;
+    ds->rows = rows;
+    ds->flip_xy = cfg->flip_xy;
+    stitch_bounds(cfg, chunks, count, ds);
+}
+
+/* If the rest of the current frame is large enough, split it at
+ * newlines, parse the pieces on separate threads, and stitch the
+ * results together. Returns false if the frame should be read
+ * serially instead, otherwise sets *res like input_read. */
+static bool read_parallel(config *cfg, struct input_map *map, data_set *ds, int *res) {
+    const char *start = &map->base[map->offset];
+    const char *end = &map->base[map->size];
+    const char *frame_end = find_blank_line(start, end);
+    size_t frame_size = frame_end - start;
+    if (frame_size < PARALLEL_MIN_FRAME) { return false; }
+
+    size_t count = frame_size / PARALLEL_MIN_CHUNK;
+    if (count > parallel_threads()) { count = parallel_threads(); }
+
+    // chunks (and their data_sets) are kept for the next frame
+    if (count > map->chunk_count) {
+        struct chunk *nchunks = realloc(map->chunks, count * sizeof(*nchunks));
+        if (nchunks == NULL) { err(1, "realloc"); }
+        memset(&nchunks[map->chunk_count], 0,
+            (count - map->chunk_count) * sizeof(*nchunks));
+        map->chunks = nchunks;
+        map->chunk_count = count;
+    }
+    struct chunk *chunks = map->chunks;
+
+    const char *p = start;
+    for (size_t i = 0; i < count; i++) {
+        const char *split = start + (i + 1) * (frame_size / count);
+        if (i == count - 1 || split >= frame_end) {
+            split = frame_end;
+        } else {
+            if (split < p) { split = p; }
+            split = scan_newline(split, frame_end);
+            if (split < frame_end) { split++; }
+        }
+        chunks[i].cfg = cfg;
+        chunks[i].start = p;
+        chunks[i].end = split;
+        chunks[i].rows = 0;
+        p = split;
+    }
+    LOG(1, "parsing %zu bytes in %zu chunks\n", frame_size, count);
+
+    parallel_run(count, parse_chunk, chunks);
+    stitch_chunks(cfg, chunks, count, ds);
+
+    if (frame_end == end) {
+        map->offset = map->size;
+        *res = -1;
+    } else {                    /* skip the blank line */
+        const char *nl = scan_newline(frame_end, end);
+        map->offset = (nl < end ? nl + 1 : end) - map->base;
+        *res = (cfg->stream_mode ? 0 : -1);
+    }
+    return true;
+}
+
+void input_close(config *cfg) {
+    struct input_map *map = cfg->in_map;
+    if (map == NULL) { return; }
+    if (map->mapped) { munmap(map->base, map->size); }
+    for (size_t i = 0; i < map->chunk_count; i++) { input_free(&map->chunks[i].ds); }
+    free(map->chunks);
+    free(map);
+    cfg->in_map = NULL;
+}
+
 static bool is_comment_marker(char c) {
     switch (c) {
     case '#': case '/':
@@ -47,63 +314,69 @@ static bool is_comment_marker(char c) {
     }
 }
 
-sink_line_res sink_line(config *cfg, data_set *ds, char *line, size_t len, size_t row_count) {
+sink_line_res sink_line(config *cfg, data_set *ds, const char *line, size_t len, size_t row_count) {
     size_t col = 0;
 
+    /* The line is not modified, and nothing past line[len - 1] is
+     * read, since it may point into a read-only mapping. */
     if (len == 0) { return SINK_LINE_EMPTY; }
-    if (line[len - 1] == '\n') { line[len - 1] = '\0'; len--; }
-    if (*line == '\0') { return SINK_LINE_EMPTY; }
-    LOG(3, "sink_line: %s\n", line);
+    if (line[len - 1] == '\n') { len--; }
+    if (len == 0 || *line == '\0') { return SINK_LINE_EMPTY; }
+    LOG(3, "sink_line: %.*s\n", (int)len, line);
     
     float cur_x = row_count;
     bool has_x = false;
+    ds->flip_xy = cfg->flip_xy;
 
     // ignore comments
     if (is_comment_marker(line[0])) { return SINK_LINE_COMMENT; }
 
+    /* Comment markers only count at the start of a cell, so rather
+     * than checking every cell, find the next marker ahead of time. */
+    const char *end = &line[len];
+    const char *comment = scan_comment(line, end);
+
     size_t offset = 0;
     while (offset < len && line[offset]) {
         double v = 0;
         if (offset >= len) { break; }
 
         // ignore comment to EOL
-        if (is_comment_marker(line[offset])) { return SINK_LINE_OK; }
+        if (&line[offset] > comment) { comment = scan_comment(&line[offset], end); }
+        if (&line[offset] == comment && is_comment_marker(*comment)) {
+            break;
+        }
 
         if (!number_head_char(line[offset])) {
             if (offset == 0) {
                 v = EMPTY_VALUE;
             } else {
                 offset++;
-                if (!number_head_char(line[offset])) {
+                if (offset == len || !number_head_char(line[offset])) {
                     v = EMPTY_VALUE;
                 }
             }
         }
 
-        char *cur_line = &line[offset];
-        char *out_line = NULL;
+        const char *cur_line = &line[offset];
+        const char *out_line = NULL;
         if (isnan(v)) {
             offset++;   // already got the value
         } else {
-            v = strtod(cur_line, &out_line);
+            v = parse_double(cur_line, end, &out_line);
             if (isinf(v)) { v = EMPTY_VALUE; }
         }
         if (out_line == cur_line) {
             break;
-        } else {
-            // could do this in terms of *line == '\0' or line[offset] == len.
-            // strtod shifts &line.
-            while(&line[offset] < out_line) {
-                offset++;
-            }
+        } else if (out_line) {
+            offset = out_line - line;
         }
 
         if (cfg->x_column && !has_x) {
             cur_x = v;
             has_x = true;
         } else {
-            point p = { .x = cur_x, .y = v };
-            add_pair(cfg, ds, row_count, col, &p);
+            add_value(ds, row_count, col, cur_x, v);
             col++;
             if (col == MAX_COLUMNS) { break; }
         }
@@ -111,8 +384,7 @@ sink_line_res sink_line(config *cfg, data_set *ds, char *line, size_t len, size_
 
     // Fill remaining columns with EMPTY_VALUE
     for (size_t c = col; c < ds->columns; c++) {
-        point p = { .x = cur_x, .y = EMPTY_VALUE };
-        add_pair(cfg, ds, row_count, c, &p);
+        add_value(ds, row_count, c, cur_x, EMPTY_VALUE);
     }
 
     return SINK_LINE_OK;
@@ -130,89 +402,117 @@ static bool number_head_char(char c) {
     }
 }
 
-#define MIN_ROW_CEIL2 1
-
-void init_pairs(data_set *ds) {
-    point **cols = calloc(1, sizeof(point *));
-    if (cols == NULL) { err(1, "calloc"); }
-
-    cols[0] = calloc(1 << MIN_ROW_CEIL2, sizeof(point));
-    if (cols[0] == NULL) { err(1, "calloc"); }
-
-    ds->row_ceil2 = MIN_ROW_CEIL2;
+/* Reset DS to a single empty column. Any storage DS already has is
+ * kept, so reading frame after frame into the same data_set stops
+ * allocating once it has seen the largest frame. */
+void init_columns(data_set *ds) {
+    if (ds->ys == NULL) {
+        double *xs = calloc(1 << MIN_ROW_CEIL2, sizeof(double));
+        double **ys = calloc(1, sizeof(double *));
+        if (xs == NULL || ys == NULL) { err(1, "calloc"); }
+
+        ys[0] = calloc(1 << MIN_ROW_CEIL2, sizeof(double));
+        if (ys[0] == NULL) { err(1, "calloc"); }
+
+        ds->row_ceil2 = MIN_ROW_CEIL2;
+        ds->column_alloc = 1;
+        ds->xs = xs;
+        ds->ys = ys;
+    }
     ds->columns = 1;
-    ds->pairs = cols;
+    ds->rows = 0;
+    ds->has_bounds = false;
+    ds->min = (point){ .x = INFINITY, .y = INFINITY };
+    ds->max = (point){ .x = -INFINITY, .y = -INFINITY };
 }
 
-static void add_pair(config *cfg, data_set *ds, size_t row, uint8_t col, point *p) {
-    // add columns, padding out empty cells as necessary
-    if (col >= ds->columns) {
-        point **npairs = realloc(ds->pairs, (1 + col) * sizeof(*npairs));
-        LOG(2, "growing ds->pairs: %p(%u) => %p(%u), %zu bytes\n",
-            ds->pairs, ds->columns, npairs, 1 + col, (1 + col) * sizeof(*npairs));
-        if (npairs == NULL) { err(1, "realloc"); }
-
-        uint8_t row_ceil2 = ds->row_ceil2;
-        if (row_ceil2 == 0) {
-            ds->row_ceil2 = MIN_ROW_CEIL2;
-            row_ceil2 = ds->row_ceil2;
-        }
-
-        point *column = calloc(1, (1 << row_ceil2) * sizeof(point));
-        if (column == NULL) { err(1, "calloc"); }
-        npairs[col] = column;
-        ds->pairs = npairs;
-        ds->columns = col + 1;
-        for (size_t i = 0; i < ds->rows; i++) {
-            point np = { .x = i, .y = EMPTY_VALUE };
-            if (cfg->x_column) {
-                assert(col > 0);
-                np.x = npairs[col][0].x;
-            }
-            npairs[col][i] = np;
+/* Make sure DS has storage for at least ROWS rows in COLUMNS columns.
+ * Every allocated column is kept the same length as xs, whether or
+ * not the current frame uses it. */
+static void reserve(data_set *ds, size_t rows, size_t columns) {
+    if (columns > ds->column_alloc) {
+        double **nys = realloc(ds->ys, columns * sizeof(*nys));
+        LOG(2, "growing ds->ys: %p(%u) => %p(%zu), %zu bytes\n",
+            (void *)ds->ys, ds->column_alloc, (void *)nys, columns, columns * sizeof(*nys));
+        if (nys == NULL) { err(1, "realloc"); }
+        ds->ys = nys;
+
+        for (size_t c = ds->column_alloc; c < columns; c++) {
+            nys[c] = malloc(((size_t)1 << ds->row_ceil2) * sizeof(double));
+            if (nys[c] == NULL) { err(1, "malloc"); }
         }
+        ds->column_alloc = columns;
     }
 
-    // grow rows
-    if (row >= (1 << ds->row_ceil2)) {
+    if (rows > ((size_t)1 << ds->row_ceil2)) {
         uint8_t nceil2 = ds->row_ceil2;
-        while ((1 << nceil2) <= row) { nceil2++; }
-
-        if (nceil2 > ds->row_ceil2) {
-            for (uint8_t c = 0; c < ds->columns; c++) {
-                point *ncol = realloc(ds->pairs[c], (1 << nceil2) * sizeof(point));
-                LOG(2, "growing column %u, %p (%d) => %p (%d, %zu bytes)\n",
-                    c, ds->pairs[c], 1 << ds->row_ceil2,
-                    ncol, 1 << nceil2, (1 << nceil2) * sizeof(point));
-                if (ncol == NULL) { err(1, "realloc"); }
-                ds->pairs[c] = ncol;
-            }
-            ds->row_ceil2 = nceil2;
+        while (((size_t)1 << nceil2) < rows) { nceil2++; }
+        size_t nsize = ((size_t)1 << nceil2) * sizeof(double);
+
+        double *nxs = realloc(ds->xs, nsize);
+        if (nxs == NULL) { err(1, "realloc"); }
+        ds->xs = nxs;
+
+        for (uint8_t c = 0; c < ds->column_alloc; c++) {
+            double *ncol = realloc(ds->ys[c], nsize);
+            LOG(2, "growing column %u, %p (%zu) => %p (%zu, %zu bytes)\n",
+                c, (void *)ds->ys[c], (size_t)1 << ds->row_ceil2,
+                (void *)ncol, (size_t)1 << nceil2, nsize);
+            if (ncol == NULL) { err(1, "realloc"); }
+            ds->ys[c] = ncol;
         }
+        ds->row_ceil2 = nceil2;
+    }
+}
+
+/* Set column COL of ROW to Y, and the row's X value to X. */
+static void add_value(data_set *ds, size_t row, uint8_t col, double x, double y) {
+    if (ds->ys == NULL) { init_columns(ds); }
+    reserve(ds, row + 1, col + 1);
+
+    // add columns, padding out empty cells as necessary
+    for (; ds->columns <= col; ds->columns++) {
+        double *column = ds->ys[ds->columns];
+        for (size_t i = 0; i < ds->rows; i++) { column[i] = EMPTY_VALUE; }
     }
 
+    // rows skipped entirely (e.g. an X value followed by a comment) are empty
+    for (size_t r = ds->rows; r < row; r++) {
+        ds->xs[r] = EMPTY_VALUE;
+        for (uint8_t c = 0; c < ds->columns; c++) { ds->ys[c][r] = EMPTY_VALUE; }
+    }
     if (row >= ds->rows) { ds->rows = row + 1; }
 
     assert(ds->columns > col);
     assert(ds->rows > row);
 
-    if (cfg->flip_xy) {
-        ds->pairs[col][row] = (point){ .x = p->y, .y = p->x };
-    } else {
-        ds->pairs[col][row] = *p;
-    }
-    LOG(2, "-- set [c:%u,r:%zu] to (%g, %g)\n",
-        col, row, ds->pairs[col][row].x, ds->pairs[col][row].y);
+    ds->xs[row] = x;
+    ds->ys[col][row] = y;
+    LOG(2, "-- set [c:%u,r:%zu] to (%g, %g)\n", col, row, x, y);
+
+    /* Keep the bounds of the complete points up to date, so drawing
+     * doesn't need another pass over the frame to find them. Empty
+     * values are masked out, rather than branched around. */
+    bool complete = !IS_EMPTY(x) & !IS_EMPTY(y);
+    double lx = (complete ? x : INFINITY);
+    double hx = (complete ? x : -INFINITY);
+    double ly = (complete ? y : INFINITY);
+    double hy = (complete ? y : -INFINITY);
+    ds->min.x = (lx < ds->min.x ? lx : ds->min.x);
+    ds->max.x = (hx > ds->max.x ? hx : ds->max.x);
+    ds->min.y = (ly < ds->min.y ? ly : ds->min.y);
+    ds->max.y = (hy > ds->max.y ? hy : ds->max.y);
+    ds->has_bounds |= complete;
 }
 
 void input_free(data_set *ds) {
-    if (ds && ds->pairs) {
-        point **pairs = ds->pairs;
-        for (uint8_t c = 0; c < ds->columns; c++) {
-            free(pairs[c]);
-            pairs[c] = NULL;
+    if (ds && ds->ys) {
+        for (uint8_t c = 0; c < ds->column_alloc; c++) {
+            free(ds->ys[c]);
+            ds->ys[c] = NULL;
         }
-        free(pairs);
+        free(ds->ys);
+        free(ds->xs);
         memset(ds, 0, sizeof(*ds));
     }
 }
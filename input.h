@@ -3,7 +3,16 @@
 
 #include "guff.h"
 
+/* Read the next frame into DS. Returns 0 at the end of a frame, -1
+ * at the end of the stream, or INPUT_BATCH when cfg->batch_rows is set
+ * and that many rows were read, so the frame continues. */
 int input_read(config *cfg, data_set *ds);
+
+#define INPUT_BATCH 1
+
 void input_free(data_set *ds);
 
+/* Release any resources held for reading cfg->in. */
+void input_close(config *cfg);
+
 #endif
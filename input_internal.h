@@ -8,7 +8,7 @@ typedef enum {
     SINK_LINE_DONE,
 } sink_line_res;
 
-void init_pairs(data_set *ds);
-sink_line_res sink_line(config *cfg, data_set *ds, char *line, size_t len, size_t row_count);
+void init_columns(data_set *ds);
+sink_line_res sink_line(config *cfg, data_set *ds, const char *line, size_t len, size_t row_count);
 
 #endif
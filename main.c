@@ -18,6 +18,10 @@
 #include "args.h"
 #include "input.h"
 #include "draw.h"
+#include "parallel.h"
+#include "raster.h"
+#include "reader.h"
+#include "window.h"
 
 static void read_env(config *cfg) {
     if (getenv("GUFF_FLIP")) { cfg->flip_xy = true; }
@@ -26,6 +30,8 @@ static void read_env(config *cfg) {
     if (value) { cfg->width = atoi(value); }
     value = getenv("GUFF_HEIGHT");
     if (value) { cfg->height = atoi(value); }
+    value = getenv("GUFF_THREADS");
+    if (value) { parallel_set_threads(atoi(value)); }
 }
 
 int main(int argc, char **argv) {
@@ -39,29 +45,73 @@ int main(int argc, char **argv) {
 
     args_handle(&cfg, argc, argv);
 
+    /* With both axes pinned, frames are rasterized a batch of rows at
+     * a time as they're read, rather than kept until they end. */
+    raster *rs = (raster_supported(&cfg) ? raster_new(&cfg) : NULL);
+
+    /* In stream mode, the next frame is read on another thread while
+     * the current one is drawn. */
+    reader *r = (cfg.stream_mode ? reader_start(&cfg) : NULL);
+
+    /* In window mode, each batch of rows read is added to a sliding
+     * window, and the whole window is drawn. */
+    window *w = (cfg.window_size > 0 ? window_new(cfg.window_size) : NULL);
+    data_set window_ds;
+
+    /* Otherwise, one data_set is reused for every frame, so its
+     * storage is only allocated while frames keep getting larger. */
+    data_set local_ds = { .ys = NULL };
     bool end_of_stream = false;
+    int res = 0;
     while (!end_of_stream) {
-        data_set ds = { .pairs = NULL };
-        int res = input_read(&cfg, &ds);
+        data_set *ds = &local_ds;
+        if (r) {
+            ds = reader_next(r, &res);
+        } else {
+            res = input_read(&cfg, ds);
+        }
+        bool batch = false;     // the frame continues in the next batch
         if (res == -1) {
             end_of_stream = true;
+            res = 0;
+        } else if (res == INPUT_BATCH) {
+            batch = true;
+            res = 0;
         } else if (res != 0) {
-            input_free(&ds);
-            return res;
+            break;
         }
-        if (ds.rows == 0) {  // no input
-            input_free(&ds);
-            return 0;
+
+        if (rs) {
+            if (ds) { raster_add(rs, ds); }
+            if (batch) { continue; }
+            if (raster_rows(rs) == 0) { break; }  // no input
+            res = raster_draw(rs);
+            if (res != 0) { break; }
+            if (!end_of_stream) { printf("\n"); }
+            continue;
+        }
+
+        if (ds == NULL || ds->rows == 0) { break; }  // no input
+
+        if (w) {
+            window_append(w, ds, cfg.x_column);
+            window_view(w, &window_ds, cfg.flip_xy);
+            ds = &window_ds;
         }
         
-        res = draw(&cfg, &ds);
-        input_free(&ds);
-        if (res != 0) { return res; }
+        res = draw(&cfg, ds);
+        if (res != 0) { break; }
 
         if (!end_of_stream) { printf("\n"); }
     }
 
+    if (r) { reader_stop(r); }
+    if (w) { window_free(w); }
+    if (rs) { raster_free(rs); }
+    input_free(&local_ds);
+    draw_close(&cfg);
+    input_close(&cfg);
     if (cfg.svg_theme) { free(cfg.svg_theme); }
     
-    return 0;
+    return res;
 }
@@ -0,0 +1,77 @@
+#define _POSIX_C_SOURCE 200809L
+#include "parallel.h"
+
+#include <pthread.h>
+
+/* Running independent tasks on worker threads. */
+
+#define MAX_THREADS 256
+
+static size_t thread_count;
+
+void parallel_set_threads(size_t count) {
+    if (count > MAX_THREADS) { count = MAX_THREADS; }
+    thread_count = count;
+}
+
+size_t parallel_threads(void) {
+    if (thread_count == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        parallel_set_threads(cpus < 1 ? 1 : (size_t)cpus);
+    }
+    return thread_count;
+}
+
+struct worker {
+    pthread_t t;
+    size_t id;
+    size_t stride;
+    size_t count;
+    parallel_cb *cb;
+    void *udata;
+};
+
+static void *worker_run(void *arg) {
+    struct worker *w = arg;
+    for (size_t i = w->id; i < w->count; i += w->stride) {
+        w->cb(i, w->udata);
+    }
+    return NULL;
+}
+
+void parallel_run(size_t count, parallel_cb *cb, void *udata) {
+    size_t threads = parallel_threads();
+    if (threads > count) { threads = count; }
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; i++) { cb(i, udata); }
+        return;
+    }
+
+    struct worker workers[MAX_THREADS];
+    for (size_t i = 0; i < threads; i++) {
+        workers[i] = (struct worker){
+            .id = i,
+            .stride = threads,
+            .count = count,
+            .cb = cb,
+            .udata = udata,
+        };
+    }
+
+    /* The calling thread takes the first share itself. If a
+     * thread can't be started, its share is run inline. */
+    bool started[MAX_THREADS] = { false };
+    for (size_t i = 1; i < threads; i++) {
+        started[i] = (0 == pthread_create(&workers[i].t, NULL,
+                worker_run, &workers[i]));
+    }
+    worker_run(&workers[0]);
+
+    for (size_t i = 1; i < threads; i++) {
+        if (started[i]) {
+            if (pthread_join(workers[i].t, NULL) != 0) { err(1, "pthread_join"); }
+        } else {
+            worker_run(&workers[i]);
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "guff.h"
+
+/* Set the number of worker threads. 0 means one per online CPU. */
+void parallel_set_threads(size_t count);
+
+/* Get the number of worker threads (at least 1). */
+size_t parallel_threads(void);
+
+typedef void parallel_cb(size_t i, void *udata);
+
+/* Call CB(i, UDATA) for every i in [0, COUNT), spread across up to
+ * parallel_threads() threads, and wait for all of them to finish.
+ * Calls for the same thread happen in increasing order of i. */
+void parallel_run(size_t count, parallel_cb *cb, void *udata);
+
+#endif
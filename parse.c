@@ -0,0 +1,152 @@
+#include "parse.h"
+
+#include <float.h>
+
+/* Locale-independent number parsing. */
+
+/* Every integer up to 2^53 is exactly representable as a double. */
+#define MAX_EXACT_MANTISSA (1ULL << 53)
+
+/* Largest power of ten that is exactly representable as a double. */
+#define MAX_EXACT_POW10 22
+
+/* Accumulating more than 19 decimal digits could overflow uint64_t. */
+#define MAX_DIGITS 19
+
+static const double pow10_table[MAX_EXACT_POW10 + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static double fallback(const char *s, const char *end, const char **out);
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+/* Note: unlike strtod(3), leading whitespace is not skipped. */
+double parse_double(const char *s, const char *end, const char **out) {
+    const char *p = s;
+    bool neg = false;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        p++;
+    }
+
+    if (p == end || !(is_digit(*p) || *p == '.')) {
+        /* inf, infinity, nan, nan(...) */
+        if (p < end && (*p == 'i' || *p == 'I' || *p == 'n' || *p == 'N')) {
+            return fallback(s, end, out);
+        }
+        *out = s;
+        return 0;
+    }
+
+    /* hex float */
+    if (*p == '0' && p + 1 < end && (p[1] == 'x' || p[1] == 'X')) {
+        return fallback(s, end, out);
+    }
+
+    uint64_t m = 0;             /* significant digits */
+    uint8_t digits = 0;         /* count of digits in m */
+    int e10 = 0;                /* decimal exponent */
+    bool any_digits = false;
+
+    for (; p < end && is_digit(*p); p++) {
+        any_digits = true;
+        if (m == 0 && *p == '0') { continue; }  /* leading zero */
+        if (digits == MAX_DIGITS) { return fallback(s, end, out); }
+        m = 10*m + (*p - '0');
+        digits++;
+    }
+
+    if (p < end && *p == '.') {
+        p++;
+        for (; p < end && is_digit(*p); p++) {
+            any_digits = true;
+            e10--;
+            if (m == 0 && *p == '0') { continue; }
+            if (digits == MAX_DIGITS) { return fallback(s, end, out); }
+            m = 10*m + (*p - '0');
+            digits++;
+        }
+    }
+
+    if (!any_digits) {          /* e.g. "." or "-.e5" */
+        *out = s;
+        return 0;
+    }
+
+    /* The exponent is only consumed if at least one digit follows. */
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *ep = p + 1;
+        bool eneg = false;
+        if (ep < end && (*ep == '-' || *ep == '+')) {
+            eneg = (*ep == '-');
+            ep++;
+        }
+        if (ep < end && is_digit(*ep)) {
+            int ev = 0;
+            for (; ep < end && is_digit(*ep); ep++) {
+                if (ev < 100000) { ev = 10*ev + (*ep - '0'); }
+            }
+            e10 += (eneg ? -ev : ev);
+            p = ep;
+        }
+    }
+
+    double v = 0;
+    if (m == 0) {
+        v = 0;
+    } else if (m <= MAX_EXACT_MANTISSA
+        && e10 >= -MAX_EXACT_POW10 && e10 <= MAX_EXACT_POW10
+        && FLT_EVAL_METHOD == 0) {
+        /* Both operands are exact, so IEEE 754 rounds the product or
+         * quotient exactly as strtod would (Clinger's fast path). */
+        v = (double)m;
+        if (e10 < 0) {
+            v /= pow10_table[-e10];
+        } else {
+            v *= pow10_table[e10];
+        }
+    } else {
+        return fallback(s, end, out);
+    }
+
+    *out = p;
+    return (neg ? -v : v);
+}
+
+/* Could c be part of anything strtod(3) would consume? */
+static bool number_char(char c) {
+    return (c >= '0' && c <= '9')
+        || (c >= 'a' && c <= 'z')
+        || (c >= 'A' && c <= 'Z')
+        || c == '+' || c == '-' || c == '.'
+        || c == '(' || c == ')' || c == '_';
+}
+
+/* Copy the candidate number into a terminated buffer and use strtod,
+ * since [s, end) may not be terminated. */
+static double fallback(const char *s, const char *end, const char **out) {
+    const char *p = s;
+    while (p < end && number_char(*p)) { p++; }
+    size_t len = p - s;
+
+    char local[64];
+    char *tmp = local;
+    if (len >= sizeof(local)) {
+        tmp = malloc(len + 1);
+        if (tmp == NULL) { err(1, "malloc"); }
+    }
+    memcpy(tmp, s, len);
+    tmp[len] = '\0';
+
+    char *tmp_out = NULL;
+    double v = strtod(tmp, &tmp_out);
+    *out = s + (tmp_out - tmp);
+
+    if (tmp != local) { free(tmp); }
+    return v;
+}
@@ -0,0 +1,13 @@
+#ifndef PARSE_H
+#define PARSE_H
+
+#include "guff.h"
+
+/* Parse a double from [s, end), returning the same value and end
+ * position as strtod(3) in the C locale. Plain decimal and scientific
+ * notation are handled directly; anything that can't be converted
+ * exactly that way (hex, inf/nan, too many digits, huge exponents)
+ * falls back on strtod. If no number is found, *out is set to s. */
+double parse_double(const char *s, const char *end, const char **out);
+
+#endif
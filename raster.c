@@ -0,0 +1,118 @@
+#include "raster.h"
+#include "draw.h"
+#include "scale.h"
+#include "counter.h"
+#include "ascii.h"
+#include "svg.h"
+
+/* Streaming rasterization, for plots with pinned bounds. */
+
+/* Rows are read and counted in batches of this many. */
+#define RASTER_BATCH_ROWS (64 * 1024)
+
+struct raster {
+    config *cfg;
+    plot_info pi;
+    size_t rows;                /* rows added to the current frame */
+    uint8_t columns;            /* columns seen in the current frame */
+    counter *counters[MAX_COLUMNS];
+
+    /* In row-count mode, each batch's rows are renumbered from the
+     * start of the frame, rather than the start of the batch. */
+    double *xs;
+    size_t xs_alloc;
+
+    struct transform_cache *transform_cache;
+};
+
+bool raster_supported(const config *cfg) {
+    return cfg->pin_x.pinned && cfg->pin_y.pinned
+        && cfg->mode != MODE_LINE && !cfg->regression
+        && cfg->window_size == 0;
+}
+
+raster *raster_new(config *cfg) {
+    assert(raster_supported(cfg));
+    raster *r = calloc(1, sizeof(*r));
+    if (r == NULL) { err(1, "calloc"); }
+    r->cfg = cfg;
+    cfg->batch_rows = RASTER_BATCH_ROWS;
+
+    plot_info *pi = &r->pi;
+    pi->log_x = cfg->log_x;
+    pi->log_y = cfg->log_y;
+    pi->pretransformed = (scale_get_transform(pi->log_x, pi->log_y) != TRANSFORM_NONE);
+    pi->pin_x = cfg->pin_x;
+    pi->pin_y = cfg->pin_y;
+    pi->clip = true;
+    pi->w = cfg->width;
+    pi->h = cfg->height;
+    pi->counters = r->counters;
+    draw_calc_pinned_bounds(pi);
+    return r;
+}
+
+void raster_add(raster *r, const data_set *ds) {
+    data_set batch = *ds;
+
+    if (!r->cfg->x_column) {
+        if (ds->rows > r->xs_alloc) {
+            double *nxs = realloc(r->xs, ds->rows * sizeof(*nxs));
+            if (nxs == NULL) { err(1, "realloc"); }
+            r->xs = nxs;
+            r->xs_alloc = ds->rows;
+        }
+        for (size_t i = 0; i < ds->rows; i++) { r->xs[i] = (float)(r->rows + i); }
+        batch.xs = r->xs;
+    }
+
+    data_set transformed;
+    transform_t t = scale_get_transform(r->pi.log_x, r->pi.log_y);
+    if (t != TRANSFORM_NONE) {
+        scale_transform_data_set(&r->transform_cache, &batch, t, &transformed);
+        batch = transformed;
+    }
+
+    for (uint8_t c = 0; c < batch.columns; c++) {
+        if (c >= r->columns) {  // first seen in this frame
+            counter *counter = counter_reset(r->counters[c],
+                r->pi.w, r->pi.h, RASTER_BATCH_ROWS);
+            if (counter == NULL) { err(1, "counter_reset"); }
+            r->counters[c] = counter;
+            r->columns = c + 1;
+        }
+        draw_count_points(r->counters[c], &r->pi, &batch, c);
+    }
+    r->rows += ds->rows;
+}
+
+size_t raster_rows(const raster *r) {
+    return r->rows;
+}
+
+int raster_draw(raster *r) {
+    int res = 0;
+    switch (r->cfg->plot_type) {
+    case PLOT_ASCII:
+        res = ascii_plot_counts(r->cfg, &r->pi, r->columns);
+        break;
+
+    case PLOT_SVG:
+        res = svg_plot_counts(r->cfg, &r->pi, r->columns);
+        break;
+
+    default:
+        assert(false);
+        break;
+    }
+    r->rows = 0;
+    r->columns = 0;
+    return res;
+}
+
+void raster_free(raster *r) {
+    for (size_t c = 0; c < MAX_COLUMNS; c++) { counter_free(r->counters[c]); }
+    free(r->xs);
+    scale_free_transform_cache(r->transform_cache);
+    free(r);
+}
@@ -0,0 +1,33 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "guff.h"
+
+/* Drawing frames as they're read, without keeping their points. When
+ * both axes' bounds are pinned (-X and -Y), each batch of rows can be
+ * counted into per-column pixel grids as soon as it's parsed, and then
+ * dropped, so memory use depends on the plot's size rather than the
+ * frame's. */
+
+typedef struct raster raster;
+
+/* Can CFG's frames be drawn this way? This needs both axes pinned, and
+ * dot or count mode, without regression lines or a sliding window. */
+bool raster_supported(const config *cfg);
+
+/* Start rasterizing frames for CFG. This sets cfg->batch_rows, so it
+ * should be called before any input is read. */
+raster *raster_new(config *cfg);
+
+/* Add a batch of rows from the current frame. */
+void raster_add(raster *r, const data_set *ds);
+
+/* How many rows have been added to the current frame? */
+size_t raster_rows(const raster *r);
+
+/* Draw the current frame, and clear it for the next. */
+int raster_draw(raster *r);
+
+void raster_free(raster *r);
+
+#endif
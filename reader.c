@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 200809L
+#include "reader.h"
+#include "input.h"
+
+#include <pthread.h>
+
+/* Background frame reader, for stream mode. */
+
+/* Frames are read into slots in round-robin order, and the reader can
+ * fill every slot except the one currently being drawn. Each slot's
+ * data_set is reused, so storage settles at SLOT_COUNT frames. */
+#define SLOT_COUNT 3
+
+struct slot {
+    data_set ds;
+    int res;
+};
+
+struct reader {
+    config *cfg;
+    pthread_t t;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+
+    /* Counts of frames read, handed out by reader_next, and released
+     * by the following reader_next call. Slot i % SLOT_COUNT holds
+     * frame i. */
+    size_t produced;
+    size_t taken;
+    size_t released;
+    bool stop;                  /* set by reader_stop */
+    bool finished;              /* set by the reader, on EOF */
+
+    struct slot slots[SLOT_COUNT];
+};
+
+static void *read_frames(void *udata) {
+    reader *r = udata;
+    for (;;) {
+        pthread_mutex_lock(&r->lock);
+        while (!r->stop && r->produced - r->released == SLOT_COUNT) {
+            pthread_cond_wait(&r->cond, &r->lock);
+        }
+        if (r->stop) {
+            pthread_mutex_unlock(&r->lock);
+            break;
+        }
+        struct slot *slot = &r->slots[r->produced % SLOT_COUNT];
+        pthread_mutex_unlock(&r->lock);
+
+        slot->res = input_read(r->cfg, &slot->ds);
+        /* An empty frame also ends the input, unless rows are read in
+         * batches; then a frame can end right after a full batch. */
+        bool last = ((slot->res != 0 && slot->res != INPUT_BATCH)
+            || (slot->ds.rows == 0 && r->cfg->batch_rows == 0));
+
+        pthread_mutex_lock(&r->lock);
+        r->produced++;
+        pthread_cond_broadcast(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+
+        if (last) { break; }
+    }
+
+    pthread_mutex_lock(&r->lock);
+    r->finished = true;
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+reader *reader_start(config *cfg) {
+    reader *r = calloc(1, sizeof(*r));
+    if (r == NULL) { err(1, "calloc"); }
+    r->cfg = cfg;
+
+    if (pthread_mutex_init(&r->lock, NULL) != 0) { err(1, "pthread_mutex_init"); }
+    if (pthread_cond_init(&r->cond, NULL) != 0) { err(1, "pthread_cond_init"); }
+
+    if (pthread_create(&r->t, NULL, read_frames, r) != 0) {
+        pthread_cond_destroy(&r->cond);
+        pthread_mutex_destroy(&r->lock);
+        free(r);
+        return NULL;
+    }
+    return r;
+}
+
+data_set *reader_next(reader *r, int *res) {
+    pthread_mutex_lock(&r->lock);
+    if (r->released < r->taken) { // done with the previous frame
+        r->released++;
+        pthread_cond_broadcast(&r->cond);
+    }
+    while (r->taken == r->produced && !r->finished) {
+        pthread_cond_wait(&r->cond, &r->lock);
+    }
+
+    struct slot *slot = NULL;
+    if (r->taken < r->produced) {
+        slot = &r->slots[r->taken % SLOT_COUNT];
+        r->taken++;
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    if (slot == NULL) {
+        *res = -1;
+        return NULL;
+    }
+    *res = slot->res;
+    return &slot->ds;
+}
+
+void reader_stop(reader *r) {
+    pthread_mutex_lock(&r->lock);
+    r->stop = true;
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+
+    if (pthread_join(r->t, NULL) != 0) { err(1, "pthread_join"); }
+    pthread_cond_destroy(&r->cond);
+    pthread_mutex_destroy(&r->lock);
+
+    for (size_t i = 0; i < SLOT_COUNT; i++) { input_free(&r->slots[i].ds); }
+    free(r);
+}
@@ -0,0 +1,26 @@
+#ifndef READER_H
+#define READER_H
+
+#include "guff.h"
+
+/* Reading frames on a background thread, so the next frame is parsed
+ * while the current one is drawn. Frames come back in input order,
+ * and the reader only gets a bounded number of frames ahead. */
+
+typedef struct reader reader;
+
+/* Start reading frames from cfg->in. Returns NULL if the thread
+ * couldn't be started, in which case the caller should use
+ * input_read directly. */
+reader *reader_start(config *cfg);
+
+/* Wait for the next frame, and set *RES as input_read would. The
+ * data_set belongs to the reader, and is only valid until the next
+ * call. Returns NULL (with *RES = -1) once the reader has stopped. */
+data_set *reader_next(reader *r, int *res);
+
+/* Stop the reader and free it. If it is in the middle of reading a
+ * frame, this waits for that frame to finish. */
+void reader_stop(reader *r);
+
+#endif
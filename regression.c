@@ -5,43 +5,43 @@
 
 // lr:{m:{(+/x)%1.0*#x};mx:m@x;my:m@y;dx:x-mx;n:+/dx*y-my;d:+/dx^2;s:n%d;(s;my-s*mx)}
 
-static bool calc_means(point *points, size_t point_count, transform_t t, double *mx, double *my);
-static double calc_num(point *points, size_t point_count, transform_t t, double mx, double my);
-static double calc_den(point *points, size_t point_count, transform_t t, double mx);
+static bool calc_means(const double *xs, const double *ys, size_t point_count, transform_t t, double *mx, double *my);
+static double calc_num(const double *xs, const double *ys, size_t point_count, transform_t t, double mx, double my);
+static double calc_den(const double *xs, const double *ys, size_t point_count, transform_t t, double mx);
 
-void regression(point *points, size_t point_count, transform_t t,
-        double *slope, double *intercept) {
+void regression(const double *xs, const double *ys, size_t point_count,
+        transform_t t, double *slope, double *intercept) {
     assert(slope);
     assert(intercept);
 
     double mx = 0;
     double my = 0;
-    if (!calc_means(points, point_count, t, &mx, &my)) {
+    if (!calc_means(xs, ys, point_count, t, &mx, &my)) {
         *slope = EMPTY_VALUE;
         *intercept = EMPTY_VALUE;
         return;
     }
 
-    double num = calc_num(points, point_count, t, mx, my);
-    double den = calc_den(points, point_count, t, mx);
+    double num = calc_num(xs, ys, point_count, t, mx, my);
+    double den = calc_den(xs, ys, point_count, t, mx);
     *slope = num / den;
     *intercept = my - *slope * mx;
 
     LOG(1, "-- slope: %g, intercept: %g\n", *slope, *intercept);
 }
 
-static bool calc_means(point *points, size_t point_count, transform_t t, double *mx, double *my) {
+static bool calc_means(const double *xs, const double *ys, size_t point_count, transform_t t, double *mx, double *my) {
     double tx = 0;
     double ty = 0;
     size_t cx = 0;
     size_t cy = 0;
     for (size_t i = 0; i < point_count; i++) {
-        point *p = &points[i];
-        if (IS_EMPTY_POINT(p)) { continue; }
+        point p = { .x = xs[i], .y = ys[i] };
+        if (IS_EMPTY(p.x) || IS_EMPTY(p.y)) { continue; }
         cx++;
         cy++;
         point tp;
-        scale_transform(p, t, &tp);
+        scale_transform(&p, t, &tp);
         tx += tp.x;
         ty += tp.y;
     }
@@ -52,23 +52,23 @@ static bool calc_means(point *points, size_t point_count, transform_t t, double
     return true;
 }
 
-static double calc_num(point *points, size_t point_count, transform_t t, double mx, double my) {
+static double calc_num(const double *xs, const double *ys, size_t point_count, transform_t t, double mx, double my) {
     double sum = 0;
     for (size_t i = 0; i < point_count; i++) {
-        point *p = &points[i];
+        point p = { .x = xs[i], .y = ys[i] };
         point tp;
-        scale_transform(p, t, &tp);
+        scale_transform(&p, t, &tp);
         sum += (tp.x - mx) * (tp.y - my);
     }
     return sum;
 }
 
-static double calc_den(point *points, size_t point_count, transform_t t, double mx) {
+static double calc_den(const double *xs, const double *ys, size_t point_count, transform_t t, double mx) {
     double sum = 0;
     for (size_t i = 0; i < point_count; i++) {
-        point *p = &points[i];
+        point p = { .x = xs[i], .y = ys[i] };
         point tp;
-        scale_transform(p, t, &tp);
+        scale_transform(&p, t, &tp);
         sum += (tp.x - mx) * (tp.x - mx);
     }
     return sum;
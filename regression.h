@@ -5,6 +5,7 @@
 #include "scale.h"
 
 /* Linear regression. */
-void regression(point *points, size_t point_count, transform_t t, double *slope, double *intercept);
+void regression(const double *xs, const double *ys, size_t point_count,
+    transform_t t, double *slope, double *intercept);
 
 #endif
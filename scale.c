@@ -1,31 +1,198 @@
 #include "scale.h"
 
+#include <float.h>
+
 /* Point scaling / transformations. */
 
-void scale_point(plot_info *pi, point *p, scaled_point *out_p, transform_t t) {
+/* Scaling, with the per-plot terms worked out once: the scaled X is
+ * (x + off_x) * mul_x, truncated, and likewise for Y before flipping. */
+struct scaler {
+    double off_x;
+    double mul_x;
+    double off_y;
+    double mul_y;
+    int32_t flip_y;
+};
+
+/* Scaled coordinates are clamped to this, which keeps the conversion
+ * to int32_t defined for points far outside the plot (or NaN). */
+#define SCALED_LIMIT ((double)(1L << 30))
+
+static void scaler_init(plot_info *pi, struct scaler *s) {
     const uint8_t pad = 2;
+    double cell_w = pi->range_x / pi->w;
+    double cell_h = pi->range_y / pi->h;
+
+    s->off_x = cell_w/2 - pi->min_x;
+    s->mul_x = (pi->w - pad) / pi->range_x;
+    s->off_y = cell_h/2 - pi->min_y;
+    s->mul_y = (pi->h - pad) / pi->range_y;
+    // flip y; 0 at bottom of plot
+    s->flip_y = pi->h - 1;
+
+    LOG(2, "range_x: %g, range_y: %g, cell_w: %g, cell_h: %g\n",
+        pi->range_x, pi->range_y, cell_w, cell_h);
+}
+
+static inline int32_t scale_coord(double v, double off, double mul) {
+    double sv = (v + off) * mul;
+    sv = (sv >= -SCALED_LIMIT ? sv : -SCALED_LIMIT);
+    sv = (sv > SCALED_LIMIT ? SCALED_LIMIT : sv);
+    return (int32_t)sv;
+}
+
+void scale_point(plot_info *pi, point *p, scaled_point *out_p, transform_t t) {
     point tp;
     scale_transform(p, t, &tp);
-    double x = tp.x;
-    double y = tp.y;
     
     double cmp_pad = 0.001;
-    assert(x >= pi->min_x - cmp_pad);
-    assert(x <= pi->max_x + cmp_pad);
+    assert(tp.x >= pi->min_x - cmp_pad);
+    assert(tp.x <= pi->max_x + cmp_pad);
 
-    double cell_w = pi->range_x / pi->w;
-    double cell_h = pi->range_y / pi->h;
+    struct scaler s;
+    scaler_init(pi, &s);
+    out_p->x = scale_coord(tp.x, s.off_x, s.mul_x);
+    out_p->y = s.flip_y - scale_coord(tp.y, s.off_y, s.mul_y);
 
-    out_p->x = (pi->w - pad) * ((x - pi->min_x + cell_w/2) / pi->range_x);
+    LOG(2, "[%d, %d] / [%zu, %zu]\n", out_p->x, out_p->y, pi->w, pi->h);
+}
 
-    int32_t oy = (pi->h - pad) * ((y - pi->min_y + cell_h/2) / pi->range_y);
-    // flip y; 0 at bottom of plot
-    out_p->y = pi->h - oy - 1;
+/* Use libm's log(3), rather than fast_log. */
+static bool exact_log;
 
-    LOG(2, "range_x: %g, range_y: %g, cell_w: %g, cell_h: %g\n",
-        pi->range_x, pi->range_y, cell_w, cell_h);
-    LOG(2, "[%u, %d | %d] / [%zu, %zu]\n",
-        out_p->x, oy, out_p->y, pi->w, pi->h);
+void scale_set_exact_log(bool exact) {
+    exact_log = exact;
+}
+
+#define LN2_HI 6.93147180369123816490e-01  /* ln(2), split so e * LN2_HI */
+#define LN2_LO 1.90821492927058770002e-10  /* is exact for any exponent */
+#define SQRT1_2_BITS 0x3fe6a09e667f3bcdULL /* sqrt(1/2), as a double */
+
+/* Approximate natural log, within about 1e-12 of log(3), which is far
+ * less than a pixel unless an axis spans a minute fraction of its
+ * values' magnitude. With x = m * 2^e, and m scaled into
+ * [sqrt(1/2), sqrt(2)), log(x) = e * ln(2) + log(m), and log(m) is
+ * 2 * atanh(s) for s = (m - 1) / (m + 1), where |s| < 0.172. The
+ * series for atanh converges quickly there.
+ *
+ * There are no branches or 64-bit integer comparisons, so loops over
+ * this can be vectorized (given -fno-trapping-math, so the compiler
+ * can evaluate both sides of each select). */
+static inline double fast_log(double x) {
+    // subnormals are scaled up into the normal range first
+    bool sub = isless(x, DBL_MIN);
+    double xn = x * (sub ? 0x1p54 : 1);
+
+    uint64_t bits;
+    memcpy(&bits, &xn, sizeof(bits));
+
+    // offset the bits so a mantissa >= sqrt(2) carries into the exponent
+    bits += 0x3ff0000000000000ULL - SQRT1_2_BITS;
+
+    // the exponent, as a double: add its bits to 2^52's mantissa
+    uint64_t ebits = 0x4330000000000000ULL + (bits >> 52) + (sub ? 0 : 54);
+    double e;
+    memcpy(&e, &ebits, sizeof(e));
+    e -= 0x1p52 + 1023 + 54;
+
+    // the mantissa, in [sqrt(1/2), sqrt(2))
+    bits = (bits & 0x000fffffffffffffULL) + SQRT1_2_BITS;
+    double m;
+    memcpy(&m, &bits, sizeof(m));
+
+    double s = (m - 1) / (m + 1);
+    double s2 = s * s;
+    double tail = s2 * (1/3.0 + s2 * (1/5.0 + s2 * (1/7.0
+        + s2 * (1/9.0 + s2 * (1/11.0 + s2 * (1/13.0))))));
+    double r = e * LN2_HI + (2 * s + (2 * s * tail + e * LN2_LO));
+
+    // same as log(3) for 0, negatives, infinity, and NaN
+    double special = (x == 0 ? -INFINITY : (isgreater(x, 0) ? x : NAN));
+    return (isgreater(x, 0) & isless(x, INFINITY) ? r : special);
+}
+
+double scale_log(double x) {
+    return (exact_log ? log(x) : fast_log(x));
+}
+
+/* Log transform. Zero maps to zero, though it's rejected for plotting. */
+static inline double log_or_zero(double v, bool exact) {
+    if (exact) { return (v == 0 ? 0 : log(v)); }
+    double l = fast_log(v);     // computed unconditionally, to vectorize
+    return (v == 0 ? 0 : l);
+}
+
+/* The loop for each transform_t is specialized, since LOG_X, LOG_Y,
+ * and EXACT are constant once this is inlined below. The loop body has
+ * no branches, so it can be vectorized (unless using libm's log). */
+static inline void scale_block(const struct scaler *s,
+        const double *xs, const double *ys, size_t count,
+        bool log_x, bool log_y, bool exact, scaled_point *out) {
+    for (size_t i = 0; i < count; i++) {
+        double x = xs[i];
+        double y = ys[i];
+        bool empty = IS_EMPTY(x) || IS_EMPTY(y);
+        x = (empty ? 0 : x);    // NaN can't be converted to int32_t
+        y = (empty ? 0 : y);
+        if (log_x) { x = log_or_zero(x, exact); }
+        if (log_y) { y = log_or_zero(y, exact); }
+
+        int32_t sx = scale_coord(x, s->off_x, s->mul_x);
+        int32_t sy = s->flip_y - scale_coord(y, s->off_y, s->mul_y);
+        out[i].x = (empty ? SCALED_EMPTY : sx);
+        out[i].y = (empty ? SCALED_EMPTY : sy);
+    }
+}
+
+/* Mark points outside PI's bounds as empty. This is only needed when
+ * the bounds were pinned, rather than fit to the points. */
+static void clip_block(plot_info *pi, const double *xs, const double *ys,
+        size_t count, transform_t t, scaled_point *out) {
+    bool log_x = (t & TRANSFORM_LOG_X) != 0;
+    bool log_y = (t & TRANSFORM_LOG_Y) != 0;
+    for (size_t i = 0; i < count; i++) {
+        double x = (log_x ? log_or_zero(xs[i], exact_log) : xs[i]);
+        double y = (log_y ? log_or_zero(ys[i], exact_log) : ys[i]);
+        bool outside = isless(x, pi->min_x) | isgreater(x, pi->max_x)
+            | isless(y, pi->min_y) | isgreater(y, pi->max_y);
+        out[i].x = (outside ? SCALED_EMPTY : out[i].x);
+        out[i].y = (outside ? SCALED_EMPTY : out[i].y);
+    }
+}
+
+void scale_points(plot_info *pi, const double *xs, const double *ys,
+        size_t count, transform_t t, scaled_point *out) {
+    struct scaler s;
+    scaler_init(pi, &s);
+
+    switch (t) {
+    case TRANSFORM_NONE:
+        scale_block(&s, xs, ys, count, false, false, false, out);
+        break;
+    case TRANSFORM_LOG_X:
+        if (exact_log) {
+            scale_block(&s, xs, ys, count, true, false, true, out);
+        } else {
+            scale_block(&s, xs, ys, count, true, false, false, out);
+        }
+        break;
+    case TRANSFORM_LOG_Y:
+        if (exact_log) {
+            scale_block(&s, xs, ys, count, false, true, true, out);
+        } else {
+            scale_block(&s, xs, ys, count, false, true, false, out);
+        }
+        break;
+    case TRANSFORM_LOG_XY:
+        if (exact_log) {
+            scale_block(&s, xs, ys, count, true, true, true, out);
+        } else {
+            scale_block(&s, xs, ys, count, true, true, false, out);
+        }
+        break;
+    }
+
+    if (pi->clip) { clip_block(pi, xs, ys, count, t, out); }
 }
 
 transform_t scale_get_transform(bool log_x, bool log_y) {
@@ -35,15 +202,164 @@ transform_t scale_get_transform(bool log_x, bool log_y) {
     return res;
 }
 
+transform_t scale_get_plot_transform(plot_info *pi) {
+    if (pi->pretransformed) { return TRANSFORM_NONE; }
+    return scale_get_transform(pi->log_x, pi->log_y);
+}
+
 void scale_transform(point *p, transform_t t, point *out) {
     if (t & TRANSFORM_LOG_X) {
-        out->x = p->x == 0 ? 0 : log(p->x);
+        out->x = log_or_zero(p->x, exact_log);
     } else {
         out->x = p->x;
     }
     if (t & TRANSFORM_LOG_Y) {
-        out->y = p->y == 0 ? 0 : log(p->y);
+        out->y = log_or_zero(p->y, exact_log);
     } else {
         out->y = p->y;
     }
 }
+
+/* Log-scaled copies of a frame's columns, kept between frames. */
+struct transform_cache {
+    size_t row_alloc;
+    double *xs;
+    double *ys[MAX_COLUMNS];
+    double *view_ys[MAX_COLUMNS];
+};
+
+static double *cache_column(struct transform_cache *cache, double **column) {
+    if (*column == NULL) {
+        *column = malloc(cache->row_alloc * sizeof(double));
+        if (*column == NULL) { err(1, "malloc"); }
+    }
+    return *column;
+}
+
+static void cache_reserve(struct transform_cache *cache, size_t rows) {
+    if (rows <= cache->row_alloc) { return; }
+    size_t nalloc = 2 * cache->row_alloc;
+    if (nalloc < rows) { nalloc = rows; }
+
+    // the old contents don't need to be kept
+    free(cache->xs);
+    cache->xs = NULL;
+    for (size_t c = 0; c < MAX_COLUMNS; c++) {
+        free(cache->ys[c]);
+        cache->ys[c] = NULL;
+    }
+    cache->row_alloc = nalloc;
+}
+
+static void log_column_exact(const double *in, double *out, size_t rows) {
+    for (size_t i = 0; i < rows; i++) { out[i] = log_or_zero(in[i], true); }
+}
+
+static void log_column_fast(const double *in, double *out, size_t rows) {
+    for (size_t i = 0; i < rows; i++) { out[i] = log_or_zero(in[i], false); }
+}
+
+#if defined(__GNUC__) && defined(__SSE2__)
+/* The same loop, 4 lanes at a time. Since C99 mode doesn't contract
+ * to FMA, the results are identical to log_column_fast's. */
+__attribute__((target("avx2")))
+static void log_column_avx2(const double *in, double *out, size_t rows) {
+    for (size_t i = 0; i < rows; i++) { out[i] = log_or_zero(in[i], false); }
+}
+#endif
+
+static void log_column(const double *in, double *out, size_t rows) {
+    static void (*fast)(const double *in, double *out, size_t rows);
+    if (exact_log) {
+        log_column_exact(in, out, rows);
+        return;
+    }
+
+    if (fast == NULL) {
+        fast = log_column_fast;
+#if defined(__GNUC__) && defined(__SSE2__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) { fast = log_column_avx2; }
+#endif
+    }
+    fast(in, out, rows);
+}
+
+/* Exit with an error for the first point that can't be log-scaled,
+ * checking in the order the points are plotted. */
+static void log_domain_error(const data_set *ds, transform_t t) {
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        const double *xs = DS_XS(ds, c);
+        const double *ys = DS_YS(ds, c);
+        for (size_t r = 0; r < ds->rows; r++) {
+            double x = xs[r];
+            double y = ys[r];
+            if (IS_EMPTY(x) || IS_EMPTY(y)) { continue; }
+            if ((t & TRANSFORM_LOG_X) && x <= 0) {
+                fprintf(stderr, "floating point error: log(%g)\n", x);
+                exit(1);
+            }
+            if ((t & TRANSFORM_LOG_Y) && y <= 0) {
+                fprintf(stderr, "floating point error: log(%g)\n", y);
+                exit(1);
+            }
+        }
+    }
+}
+
+void scale_transform_data_set(struct transform_cache **cache_p,
+        const data_set *ds, transform_t t, data_set *out) {
+    struct transform_cache *cache = *cache_p;
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(*cache));
+        if (cache == NULL) { err(1, "calloc"); }
+        *cache_p = cache;
+    }
+    cache_reserve(cache, ds->rows);
+
+    // xs is shared by every column, so it's transformed once
+    bool log_xs = (t & (ds->flip_xy ? TRANSFORM_LOG_Y : TRANSFORM_LOG_X)) != 0;
+    bool log_ys = (t & (ds->flip_xy ? TRANSFORM_LOG_X : TRANSFORM_LOG_Y)) != 0;
+
+    // check that every complete point is in log's domain
+    bool bad = false;
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        const double *ys = ds->ys[c];
+        for (size_t r = 0; r < ds->rows; r++) {
+            double x = ds->xs[r];
+            double y = ys[r];
+            bool complete = !IS_EMPTY(x) & !IS_EMPTY(y);
+            bad |= complete & ((log_xs & (x <= 0)) | (log_ys & (y <= 0)));
+        }
+    }
+    if (bad) { log_domain_error(ds, t); }
+
+    *out = *ds;
+    out->ys = cache->view_ys;
+
+    if (log_xs) {
+        out->xs = cache_column(cache, &cache->xs);
+        log_column(ds->xs, out->xs, ds->rows);
+        out->min.x = log_or_zero(ds->min.x, exact_log);
+        out->max.x = log_or_zero(ds->max.x, exact_log);
+    }
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        if (log_ys) {
+            out->ys[c] = cache_column(cache, &cache->ys[c]);
+            log_column(ds->ys[c], out->ys[c], ds->rows);
+        } else {
+            out->ys[c] = ds->ys[c];
+        }
+    }
+    if (log_ys) {
+        out->min.y = log_or_zero(ds->min.y, exact_log);
+        out->max.y = log_or_zero(ds->max.y, exact_log);
+    }
+}
+
+void scale_free_transform_cache(struct transform_cache *cache) {
+    if (cache == NULL) { return; }
+    free(cache->xs);
+    for (size_t c = 0; c < MAX_COLUMNS; c++) { free(cache->ys[c]); }
+    free(cache);
+}
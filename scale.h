@@ -16,9 +16,43 @@ typedef enum {
     TRANSFORM_LOG_XY = 3,
 } transform_t;
 
+/* Scaled coordinates for a point with an empty X or Y. */
+#define SCALED_EMPTY INT32_MIN
+
+/* How many points callers scale at a time, with scale_points. */
+#define SCALE_BLOCK 1024
+
 void scale_point(plot_info *pi, point *p, scaled_point *out_p, transform_t t);
 
+/* Scale COUNT points, with X and Y values from XS and YS, into OUT.
+ * This is equivalent to scale_point on each, except that points with
+ * an empty X or Y are scaled to SCALED_EMPTY, and points outside the
+ * plot's bounds aren't checked for (unless pi->clip is set, in which
+ * case they're also scaled to SCALED_EMPTY). */
+void scale_points(plot_info *pi, const double *xs, const double *ys,
+    size_t count, transform_t t, scaled_point *out);
+
 transform_t scale_get_transform(bool log_x, bool log_y);
+
+/* Natural log, as used for log-scaled plots. By default this is a
+ * vectorizable approximation, accurate to well under a pixel; with
+ * scale_set_exact_log(true), it uses libm's log(3) instead. */
+double scale_log(double x);
+void scale_set_exact_log(bool exact);
+
+/* The transform still to be applied to the values PI plots, which is
+ * none if they were log-scaled up front. */
+transform_t scale_get_plot_transform(plot_info *pi);
 void scale_transform(point *p, transform_t t, point *out);
 
+/* Set OUT to a view of DS with T already applied, so the log of each
+ * value is only taken once per frame. Columns that T doesn't affect
+ * are shared with DS; the transformed ones are kept in *CACHE (which
+ * is allocated if NULL) and reused for later frames. Exits with an
+ * error if a point to be plotted is outside log's domain. */
+void scale_transform_data_set(struct transform_cache **cache,
+    const data_set *ds, transform_t t, data_set *out);
+
+void scale_free_transform_cache(struct transform_cache *cache);
+
 #endif
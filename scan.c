@@ -0,0 +1,97 @@
+#include "scan.h"
+
+/* Vectorized byte scanning. */
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+/* Each implementation finds the first byte equal to a, b, or c. */
+typedef const char *find3_fun(const char *p, const char *end,
+    char a, char b, char c);
+
+static const char *find3_init(const char *p, const char *end,
+    char a, char b, char c);
+
+static find3_fun *find3 = find3_init;
+
+const char *scan_newline(const char *p, const char *end) {
+    return find3(p, end, '\n', '\n', '\n');
+}
+
+const char *scan_comment(const char *p, const char *end) {
+    return find3(p, end, '#', '/', '\0');
+}
+
+static const char *find3_scalar(const char *p, const char *end,
+        char a, char b, char c) {
+    for (; p < end; p++) {
+        if (*p == a || *p == b || *p == c) { return p; }
+    }
+    return end;
+}
+
+#ifdef SCAN_X86
+static const char *find3_sse2(const char *p, const char *end,
+        char a, char b, char c) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    const __m128i vc = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(v, va),
+            _mm_or_si128(_mm_cmpeq_epi8(v, vb), _mm_cmpeq_epi8(v, vc)));
+        unsigned mask = _mm_movemask_epi8(hits);
+        if (mask) { return p + __builtin_ctz(mask); }
+    }
+    return find3_scalar(p, end, a, b, c);
+}
+
+__attribute__((target("avx2")))
+static const char *find3_avx2(const char *p, const char *end,
+        char a, char b, char c) {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    const __m256i vc = _mm256_set1_epi8(c);
+    for (; end - p >= 32; p += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(v, va),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, vb), _mm256_cmpeq_epi8(v, vc)));
+        unsigned mask = _mm256_movemask_epi8(hits);
+        if (mask) { return p + __builtin_ctz(mask); }
+    }
+    return find3_sse2(p, end, a, b, c);
+}
+#endif
+
+bool scan_set_impl(scan_impl_t impl) {
+    switch (impl) {
+    case SCAN_IMPL_SCALAR:
+        find3 = find3_scalar;
+        return true;
+#ifdef SCAN_X86
+    case SCAN_IMPL_SSE2:
+        find3 = find3_sse2;
+        return true;
+    case SCAN_IMPL_AVX2:
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("avx2")) { return false; }
+        find3 = find3_avx2;
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+/* Pick the widest supported implementation, then scan. */
+static const char *find3_init(const char *p, const char *end,
+        char a, char b, char c) {
+    if (!scan_set_impl(SCAN_IMPL_AVX2)) {
+        if (!scan_set_impl(SCAN_IMPL_SSE2)) {
+            scan_set_impl(SCAN_IMPL_SCALAR);
+        }
+    }
+    return find3(p, end, a, b, c);
+}
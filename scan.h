@@ -0,0 +1,27 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "guff.h"
+
+/* Byte scanning for the input tokenizer, 16 (SSE2) or 32 (AVX2) bytes
+ * at a time, with a scalar fallback. The implementation is picked at
+ * runtime, the first time either scan function is called. */
+
+typedef enum {
+    SCAN_IMPL_SCALAR,
+    SCAN_IMPL_SSE2,
+    SCAN_IMPL_AVX2,
+} scan_impl_t;
+
+/* Return a pointer to the first '\n' in [p, end), or end. */
+const char *scan_newline(const char *p, const char *end);
+
+/* Return a pointer to the first comment marker ('#' or '/') or '\0'
+ * in [p, end), or end. */
+const char *scan_comment(const char *p, const char *end);
+
+/* Force a particular implementation (for testing and benchmarks).
+ * Returns false if the CPU doesn't support it. */
+bool scan_set_impl(scan_impl_t impl);
+
+#endif
@@ -0,0 +1,133 @@
+#include "simplify.h"
+
+/* Visvalingam-Whyatt polyline simplification. */
+
+/* Scratch space, for the vertices still in the line (as a doubly
+ * linked list) and a min-heap of their areas. */
+typedef struct {
+    size_t *prev;
+    size_t *next;
+    double *area;               /* doubled, to save a division */
+    size_t *heap;               /* vertex ids, smallest area first */
+    size_t *pos;                /* each vertex's position in the heap */
+    size_t heap_count;
+} vw_state;
+
+/* Twice the area of the triangle ABC. This is exact for any points
+ * within a few million pixels of each other. */
+static double doubled_area(scaled_point a, scaled_point b, scaled_point c) {
+    double cross = ((double)b.x - a.x) * ((double)c.y - a.y)
+        - ((double)c.x - a.x) * ((double)b.y - a.y);
+    return fabs(cross);
+}
+
+/* Order by area, then by position in the line, so ties are broken the
+ * same way every time. */
+static bool before(const vw_state *s, size_t a, size_t b) {
+    if (s->area[a] != s->area[b]) { return s->area[a] < s->area[b]; }
+    return a < b;
+}
+
+static void heap_swap(vw_state *s, size_t i, size_t j) {
+    size_t t = s->heap[i];
+    s->heap[i] = s->heap[j];
+    s->heap[j] = t;
+    s->pos[s->heap[i]] = i;
+    s->pos[s->heap[j]] = j;
+}
+
+static void sift_up(vw_state *s, size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!before(s, s->heap[i], s->heap[parent])) { break; }
+        heap_swap(s, i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(vw_state *s, size_t i) {
+    for (;;) {
+        size_t l = 2 * i + 1;
+        size_t r = l + 1;
+        size_t min = i;
+        if (l < s->heap_count && before(s, s->heap[l], s->heap[min])) { min = l; }
+        if (r < s->heap_count && before(s, s->heap[r], s->heap[min])) { min = r; }
+        if (min == i) { break; }
+        heap_swap(s, i, min);
+        i = min;
+    }
+}
+
+/* Recompute vertex V's area after a neighbor was removed. Its area
+ * never drops below that of the vertex just removed (REMOVED), so each
+ * vertex's area is at least that of every one removed before it. */
+static void update(vw_state *s, const scaled_point *ps, size_t v, double removed) {
+    double area = doubled_area(ps[s->prev[v]], ps[v], ps[s->next[v]]);
+    if (area < removed) { area = removed; }
+    double old = s->area[v];
+    s->area[v] = area;
+    if (area < old) {
+        sift_up(s, s->pos[v]);
+    } else {
+        sift_down(s, s->pos[v]);
+    }
+}
+
+size_t simplify_polyline(scaled_point *ps, size_t count, double min_area) {
+    if (count <= 2) { return count; }
+
+    vw_state s;
+    s.prev = malloc(count * sizeof(*s.prev));
+    s.next = malloc(count * sizeof(*s.next));
+    s.area = malloc(count * sizeof(*s.area));
+    s.heap = malloc(count * sizeof(*s.heap));
+    s.pos = malloc(count * sizeof(*s.pos));
+    if (s.prev == NULL || s.next == NULL || s.area == NULL
+        || s.heap == NULL || s.pos == NULL) {
+        err(1, "malloc");
+    }
+
+    // only the interior vertices can be removed
+    s.heap_count = 0;
+    for (size_t i = 1; i < count - 1; i++) {
+        s.prev[i] = i - 1;
+        s.next[i] = i + 1;
+        s.area[i] = doubled_area(ps[i - 1], ps[i], ps[i + 1]);
+        s.heap[s.heap_count] = i;
+        s.pos[i] = s.heap_count;
+        s.heap_count++;
+    }
+    s.next[0] = 1;
+    s.prev[count - 1] = count - 2;
+    for (size_t i = s.heap_count / 2; i-- > 0;) { sift_down(&s, i); }
+
+    double limit = 2 * min_area;
+    while (s.heap_count > 0 && s.area[s.heap[0]] < limit) {
+        size_t v = s.heap[0];
+        double removed = s.area[v];
+        heap_swap(&s, 0, s.heap_count - 1);
+        s.heap_count--;
+        sift_down(&s, 0);
+
+        size_t p = s.prev[v];
+        size_t n = s.next[v];
+        s.next[p] = n;
+        s.prev[n] = p;
+        if (p > 0) { update(&s, ps, p, removed); }
+        if (n < count - 1) { update(&s, ps, n, removed); }
+    }
+
+    // compact the vertices that are left, in order
+    size_t out = 0;
+    for (size_t i = 0; i < count; i = s.next[i]) {
+        ps[out++] = ps[i];
+        if (i == count - 1) { break; }
+    }
+
+    free(s.prev);
+    free(s.next);
+    free(s.area);
+    free(s.heap);
+    free(s.pos);
+    return out;
+}
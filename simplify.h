@@ -0,0 +1,19 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "guff.h"
+#include "scale.h"
+
+/* Polyline simplification, for line mode: Visvalingam-Whyatt, which
+ * repeatedly drops the vertex whose triangle with its two neighbors
+ * has the smallest area, until every remaining one is at least some
+ * minimum. Unlike pixel-column decimation, this doesn't depend on the
+ * points' order along the X axis, so it also thins out curves that
+ * double back on themselves. It takes O(n log n) time. */
+
+/* Simplify the COUNT vertices in PS, in place, dropping vertices whose
+ * effective area is under MIN_AREA square pixels. The first and last
+ * vertices are always kept. Returns the number of vertices left. */
+size_t simplify_polyline(scaled_point *ps, size_t count, double min_area);
+
+#endif
@@ -2,6 +2,9 @@
 #include "regression.h"
 #include "scale.h"
 #include "counter.h"
+#include "hexbin.h"
+#include "emit.h"
+#include "simplify.h"
 
 /* SVG generation. */
 
@@ -14,32 +17,321 @@ static void svg_printf_begin_polyline(void);
 static void svg_printf_polyline_point(size_t x, size_t y);
 static void svg_printf_end_polyline(char *color, size_t line_width);
 static void svg_printf_circle(size_t x, size_t y, size_t point_size, char *color);
-static void svg_printf_axis(plot_info *pi, svg_theme *theme);
+static void svg_printf_class_circle(size_t x, size_t y, size_t point_size, uint8_t c);
+static void svg_printf_rect(size_t x, size_t y, size_t w, size_t h, char *color);
+static void svg_printf_hex(double x, double y, double half_w, double top, double side, char *color);
+static void svg_printf_line(int64_t x1, int64_t y1, int64_t x2, int64_t y2,
+    char *color, size_t width, bool dashed);
+static void svg_printf_axis(config *cfg, plot_info *pi);
 static void svg_printf_regression_line(plot_info *pi, char *color, double slope, double intercept);
 static void svg_printf_end(void);
 
-int svg_plot(config *cfg, plot_info *pi, data_set *ds) {
+/* In compact mode, each column's dots are one path: an absolute move to
+ * the first dot, then relative lineto segments to the rest. .dN hides
+ * the segments (no stroke or fill), and a marker draws the same circle
+ * at every vertex, so only the dots show. Lines are one path per column
+ * too, with a subpath per unbroken run. Styles go in CSS classes: .cN
+ * for column N's color, .dN for its dot paths, .l for lines, and .t
+ * for axis ticks. */
+static void svg_printf_styles(config *cfg, uint8_t columns) {
+    svg_theme *theme = cfg->svg_theme;
+    bool dots = (cfg->mode == MODE_DOT);
+    emit_str("<style>\n.t{stroke:");
+    emit_str(theme->axis_color);
+    emit_str(";stroke-width:1}\n");
+    if (cfg->mode == MODE_LINE) {
+        emit_str(".l{fill:none;stroke-width:");
+        emit_uint(theme->line_width);
+        emit_str("}\n");
+    }
+    for (uint8_t c = 0; c < columns; c++) {
+        emit_str(".c");
+        emit_uint(c);
+        emit_str("{stroke:");
+        emit_str(get_color(c, theme));
+        emit_str("}\n");
+        if (dots) {
+            emit_str(".d");
+            emit_uint(c);
+            emit_str("{fill:none;stroke:none;marker:url(#m");
+            emit_uint(c);
+            emit_str(")}\n");
+        }
+    }
+    emit_str("</style>\n");
+    if (!dots) { return; }
+
+    emit_str("<defs>\n");
+    for (uint8_t c = 0; c < columns; c++) {
+        emit_str("<marker id=\"m");
+        emit_uint(c);
+        emit_str("\" markerUnits=\"userSpaceOnUse\" overflow=\"visible\">"
+            "<circle r=\"");
+        emit_uint(SVG_DEF_POINT_SIZE);
+        emit_str("\" stroke=\"");
+        emit_str(get_color(c, theme));
+        emit_str("\"/></marker>\n");
+    }
+    emit_str("</defs>\n");
+}
+
+static void begin_plot(config *cfg, plot_info *pi, uint8_t columns) {
     svg_theme *theme = cfg->svg_theme;
     svg_printf_header(pi->w, pi->h);
+    if (cfg->svg_compact) { svg_printf_styles(cfg, columns); }
     svg_printf_frame(pi->w, pi->h, theme->bg_color, theme->border_width, theme->border_color);
 
     if (cfg->axis) {
         draw_calc_axis_pos(pi);
-        svg_printf_axis(pi, theme);
+        svg_printf_axis(cfg, pi);
     }
+}
 
-    transform_t transform = scale_get_transform(pi->log_x, pi->log_y);
+/* Path data for compact mode: each subpath starts with an absolute
+ * move, and the points after it are relative lines. */
+typedef struct {
+    bool markers;               /* are the path's vertices marked? */
+    size_t subpath;             /* points in the current subpath */
+    bool sep;                   /* does the next number need a separator? */
+    size_t count;               /* points so far, for line breaks */
+    int64_t x, y;               /* the last point */
+} svg_path;
+
+/* Points per line of path data, to keep lines a readable length. */
+#define PATH_LINE_POINTS 16
+
+/* Start a path styled by CLASS, suffixed with COLUMN if it's >= 0. */
+static void svg_printf_begin_path(svg_path *p, const char *class, int column) {
+    emit_str("<path class=\"");
+    emit_str(class);
+    if (column >= 0) { emit_uint(column); }
+    emit_str("\" d=\"");
+    *p = (svg_path){ .count = 0 };
+}
 
-    for (uint8_t c = 0; c < ds->columns; c++) {
-        char *color = get_color(c, theme);
-        point *column = ds->pairs[c];
-
-        if (cfg->mode == MODE_LINE) {
-            bool beginning_line = true;
-            for (size_t i = 0; i < ds->rows; i++) {
-                point *p = &column[i];
-                if (IS_EMPTY(p->x) || IS_EMPTY(p->y)) {
+static void path_number(svg_path *p, int64_t v) {
+    if (p->sep && v >= 0) { emit_str(" "); }  // '-' separates on its own
+    emit_int(v);
+    p->sep = true;
+}
+
+static void svg_printf_path_point(svg_path *p, int64_t x, int64_t y) {
+    if (p->count > 0 && p->count % PATH_LINE_POINTS == 0) {
+        emit_str("\n");
+        p->sep = false;
+    }
+    if (p->subpath == 0) {
+        emit_str("M");
+        p->sep = false;
+        path_number(p, x);
+        path_number(p, y);
+    } else {
+        if (p->subpath == 1) {
+            emit_str("l");
+            p->sep = false;
+        }
+        path_number(p, x - p->x);
+        path_number(p, y - p->y);
+    }
+    p->x = x;
+    p->y = y;
+    p->subpath++;
+    p->count++;
+}
+
+/* Start column C's path of dots. */
+static void svg_printf_begin_dots(svg_path *p, uint8_t c) {
+    svg_printf_begin_path(p, "d", c);
+    p->markers = true;
+}
+
+/* The next point starts a new subpath. */
+static void svg_printf_path_break(svg_path *p) {
+    p->subpath = 0;
+}
+
+static void svg_printf_end_path(svg_path *p) {
+    /* A dot path's markers land on its lineto vertices. A path with
+     * only a moveto may not get any, so add a zero-length segment. */
+    if (p->markers && p->count == 1) { emit_str("l0 0"); }
+    emit_str("\"/>\n");
+}
+
+/* Radius for a point, in count mode scaled by the pixel's count. */
+static size_t point_size(config *cfg, size_t count) {
+    return SVG_DEF_POINT_SIZE + (cfg->log_count ? scale_log(count) : count);
+}
+
+/* One bit per pixel, marking where a column's dots have already
+ * been drawn. A dot drawn again on the same pixel, in the same color,
+ * looks the same, so only the first is drawn, and dot mode's output
+ * grows with the plot's area rather than its number of points. */
+typedef struct {
+    size_t w, h;
+    uint64_t *bits;
+} pixel_bitmap;
+
+static void bitmap_init(pixel_bitmap *b, size_t w, size_t h) {
+    b->w = w;
+    b->h = h;
+    b->bits = calloc((w * h + 63) / 64, sizeof(*b->bits));
+    if (b->bits == NULL) { err(1, "calloc"); }
+}
+
+static void bitmap_clear(pixel_bitmap *b) {
+    memset(b->bits, 0, (b->w * b->h + 63) / 64 * sizeof(*b->bits));
+}
+
+/* Mark a pixel as drawn, and return whether it already was. Points off
+ * the plot aren't tracked, so they're always drawn. */
+static bool bitmap_test_and_set(pixel_bitmap *b, scaled_point sp) {
+    if ((uint32_t)sp.x >= b->w || (uint32_t)sp.y >= b->h) { return false; }
+    size_t i = (size_t)sp.y * b->w + (size_t)sp.x;
+    uint64_t bit = (uint64_t)1 << (i & 63);
+    bool set = (b->bits[i / 64] & bit) != 0;
+    b->bits[i / 64] |= bit;
+    return set;
+}
+
+/* M4 decimation, for line mode. Within a run of consecutive points in
+ * the same pixel column, the line only ever moves vertically, so only
+ * the run's first, lowest, highest, and last points affect what's
+ * drawn: the rest lie on the segment between the lowest and highest.
+ * Lines get at most 4 vertices per pixel column, however many points
+ * there are. */
+typedef struct {
+    size_t n;                   /* points in the current run */
+    scaled_point first, min, max, last;
+    size_t min_i, max_i;        /* min and max's positions in the run */
+} m4_run;
+
+/* Take the vertices to draw for the current run, in their original
+ * order, into OUT, and start a new run. Returns how many there are. */
+static size_t m4_take(m4_run *m, scaled_point out[4]) {
+    if (m->n == 0) { return 0; }
+    size_t is[4] = { 0, m->min_i, m->max_i, m->n - 1 };
+    scaled_point ps[4] = { m->first, m->min, m->max, m->last };
+
+    // sort the four by position, then drop repeats
+    for (size_t i = 1; i < 4; i++) {
+        for (size_t j = i; j > 0 && is[j - 1] > is[j]; j--) {
+            size_t ti = is[j]; is[j] = is[j - 1]; is[j - 1] = ti;
+            scaled_point tp = ps[j]; ps[j] = ps[j - 1]; ps[j - 1] = tp;
+        }
+    }
+    size_t count = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (i > 0 && is[i] == is[i - 1]) { continue; }
+        out[count++] = ps[i];
+    }
+    m->n = 0;
+    return count;
+}
+
+/* Add a point to the current run. If it's in a different pixel column,
+ * the run is finished first, and its vertices are put in OUT. */
+static size_t m4_add(m4_run *m, scaled_point sp, scaled_point out[4]) {
+    size_t count = 0;
+    if (m->n > 0 && sp.x != m->first.x) { count = m4_take(m, out); }
+    if (m->n == 0) {
+        m->first = m->min = m->max = sp;
+        m->min_i = m->max_i = 0;
+    } else if (sp.y < m->min.y) {
+        m->min = sp;
+        m->min_i = m->n;
+    } else if (sp.y > m->max.y) {
+        m->max = sp;
+        m->max_i = m->n;
+    }
+    m->last = sp;
+    m->n++;
+    return count;
+}
+
+/* With -t, a line's vertices are simplified before they're drawn, up
+ * to SIMPLIFY_WINDOW at a time, so memory use doesn't grow with the
+ * input. Each window's last vertex is kept, and starts the next. */
+#define SIMPLIFY_WINDOW (64 * 1024)
+
+typedef struct {
+    svg_path *path;             /* compact output, or NULL for polylines */
+    double min_area;            /* in square pixels, or 0 to draw all */
+    scaled_point *buf;
+    size_t count;
+} line_out;
+
+static void line_init(line_out *o, config *cfg, svg_path *path) {
+    double tol = cfg->simplify_tol;
+    *o = (line_out){ .path = path, .min_area = tol * tol };
+    if (o->min_area > 0) {
+        o->buf = malloc(SIMPLIFY_WINDOW * sizeof(*o->buf));
+        if (o->buf == NULL) { err(1, "malloc"); }
+    }
+}
+
+static void line_emit(line_out *o, const scaled_point *vs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (o->path) {
+            svg_printf_path_point(o->path, vs[i].x, vs[i].y);
+        } else {
+            svg_printf_polyline_point(vs[i].x, vs[i].y);
+        }
+    }
+}
+
+/* Add COUNT vertices to the current line. */
+static void line_add(line_out *o, const scaled_point *vs, size_t count) {
+    if (o->buf == NULL) {
+        line_emit(o, vs, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (o->count == SIMPLIFY_WINDOW) {
+            size_t left = simplify_polyline(o->buf, o->count, o->min_area);
+            line_emit(o, o->buf, left - 1);
+            o->buf[0] = o->buf[left - 1];
+            o->count = 1;
+        }
+        o->buf[o->count++] = vs[i];
+    }
+}
+
+/* Finish the current line, drawing whatever vertices are left. */
+static void line_end(line_out *o) {
+    if (o->count > 0) {
+        line_emit(o, o->buf, simplify_polyline(o->buf, o->count, o->min_area));
+        o->count = 0;
+    }
+}
+
+/* Draw column C's points one at a time, as dots or lines. Dots whose
+ * pixel is already marked in DRAWN are skipped. */
+static void plot_points(config *cfg, plot_info *pi, data_set *ds, uint8_t c,
+        pixel_bitmap *drawn) {
+    svg_theme *theme = cfg->svg_theme;
+    char *color = get_color(c, theme);
+    transform_t transform = scale_get_plot_transform(pi);
+    const double *xs = DS_XS(ds, c);
+    const double *ys = DS_YS(ds, c);
+    bool beginning_line = true;
+    scaled_point sps[SCALE_BLOCK];
+    m4_run m4 = { .n = 0 };
+    scaled_point vs[4];
+    line_out line;
+    line_init(&line, cfg, NULL);
+
+    for (size_t r = 0; r < ds->rows; r += SCALE_BLOCK) {
+        size_t block = ds->rows - r;
+        if (block > SCALE_BLOCK) { block = SCALE_BLOCK; }
+        scale_points(pi, &xs[r], &ys[r], block, transform, sps);
+
+        for (size_t i = 0; i < block; i++) {
+            scaled_point sp = sps[i];
+            if (cfg->mode == MODE_LINE) {
+                if (sp.x == SCALED_EMPTY) {
                     if (!beginning_line) {
+                        line_add(&line, vs, m4_take(&m4, vs));
+                        line_end(&line);
                         svg_printf_end_polyline(color, theme->line_width);
                     }
                     beginning_line = true;
@@ -50,24 +342,219 @@ int svg_plot(config *cfg, plot_info *pi, data_set *ds) {
                     svg_printf_begin_polyline();
                     beginning_line = false;
                 }
-                scaled_point sp;
-                scale_point(pi, p, &sp, transform);
-                svg_printf_polyline_point(sp.x, sp.y);
+                line_add(&line, vs, m4_add(&m4, sp, vs));
+            } else {
+                if (sp.x == SCALED_EMPTY) { continue; }
+                if (bitmap_test_and_set(drawn, sp)) { continue; }
+                svg_printf_circle(sp.x, sp.y, SVG_DEF_POINT_SIZE, color);
             }
-            svg_printf_end_polyline(color, theme->line_width);
-        } else {
-            for (size_t i = 0; i < ds->rows; i++) {
-                point *p = &column[i];
-                scaled_point sp;
-                scale_point(pi, p, &sp, transform);
-
-                if (IS_EMPTY(p->x) || IS_EMPTY(p->y)) { continue; }
-                size_t point_size = SVG_DEF_POINT_SIZE;
-                if (pi->counters) {
-                    size_t count = counter_get(pi->counters[c], sp.x, sp.y);
-                    point_size = SVG_DEF_POINT_SIZE + (cfg->log_count ? log(count) : count);
+        }
+    }
+    if (cfg->mode == MODE_LINE) {
+        line_add(&line, vs, m4_take(&m4, vs));
+        line_end(&line);
+        svg_printf_end_polyline(color, theme->line_width);
+    }
+    free(line.buf);
+}
+
+/* Draw column C's points as one path, as dots or lines. */
+static void plot_points_compact(config *cfg, plot_info *pi, data_set *ds, uint8_t c,
+        pixel_bitmap *drawn) {
+    transform_t transform = scale_get_plot_transform(pi);
+    const double *xs = DS_XS(ds, c);
+    const double *ys = DS_YS(ds, c);
+    scaled_point sps[SCALE_BLOCK];
+    m4_run m4 = { .n = 0 };
+    scaled_point vs[4];
+    svg_path path;
+    line_out line;
+    line_init(&line, cfg, &path);
+    if (cfg->mode == MODE_LINE) {
+        svg_printf_begin_path(&path, "l c", c);
+    } else {
+        svg_printf_begin_dots(&path, c);
+    }
+
+    for (size_t r = 0; r < ds->rows; r += SCALE_BLOCK) {
+        size_t block = ds->rows - r;
+        if (block > SCALE_BLOCK) { block = SCALE_BLOCK; }
+        scale_points(pi, &xs[r], &ys[r], block, transform, sps);
+
+        for (size_t i = 0; i < block; i++) {
+            scaled_point sp = sps[i];
+            if (cfg->mode == MODE_LINE) {
+                if (sp.x == SCALED_EMPTY) {
+                    line_add(&line, vs, m4_take(&m4, vs));
+                    line_end(&line);
+                    svg_printf_path_break(&path);
+                } else {
+                    line_add(&line, vs, m4_add(&m4, sp, vs));
                 }
-                svg_printf_circle(sp.x, sp.y, point_size, color);
+            } else if (sp.x != SCALED_EMPTY && !bitmap_test_and_set(drawn, sp)) {
+                svg_printf_path_point(&path, sp.x, sp.y);
+            }
+        }
+    }
+    line_add(&line, vs, m4_take(&m4, vs));
+    line_end(&line);
+    svg_printf_end_path(&path);
+    free(line.buf);
+}
+
+/* Draw one circle per pixel with a nonzero count in column C's
+ * counter, rather than one per point counted there, since circles
+ * of the same color and size on the same pixel look like one. */
+static void plot_counts(config *cfg, plot_info *pi, uint8_t c) {
+    char *color = get_color(c, cfg->svg_theme);
+    size_t pos = 0;
+    counter_cell cell;
+    svg_path path;
+    bool dot_path = (cfg->svg_compact && cfg->mode == MODE_DOT);
+    if (dot_path) { svg_printf_begin_dots(&path, c); }
+
+    while (counter_next(pi->counters[c], &pos, &cell)) {
+        if (dot_path) {
+            svg_printf_path_point(&path, cell.x, cell.y);
+            continue;
+        }
+        size_t size = (cfg->mode == MODE_COUNT
+            ? point_size(cfg, cell.count) : SVG_DEF_POINT_SIZE);
+        if (cfg->svg_compact) {
+            svg_printf_class_circle(cell.x, cell.y, size, c);
+        } else {
+            svg_printf_circle(cell.x, cell.y, size, color);
+        }
+    }
+    if (dot_path) { svg_printf_end_path(&path); }
+}
+
+/* Heat map colors, from sparsest to densest: viridis, as in
+ * matplotlib, which stays distinct for colorblind viewers. */
+static const uint8_t heat_ramp[][3] = {
+    { 0x44, 0x01, 0x54 },
+    { 0x3b, 0x52, 0x8b },
+    { 0x21, 0x91, 0x8c },
+    { 0x5e, 0xc9, 0x62 },
+    { 0xfd, 0xe7, 0x25 },
+};
+#define HEAT_RAMP_STOPS (sizeof(heat_ramp) / sizeof(heat_ramp[0]))
+
+/* Format the ramp color at T, in [0, 1], into BUF. */
+static void heat_color(double t, char buf[8]) {
+    double pos = t * (HEAT_RAMP_STOPS - 1);
+    size_t i = (size_t)pos;
+    if (i > HEAT_RAMP_STOPS - 2) { i = HEAT_RAMP_STOPS - 2; }
+    double f = pos - i;
+    uint8_t rgb[3];
+    for (size_t ch = 0; ch < 3; ch++) {
+        double lo = heat_ramp[i][ch];
+        double hi = heat_ramp[i + 1][ch];
+        rgb[ch] = (uint8_t)(lo + f * (hi - lo) + 0.5);
+    }
+    snprintf(buf, 8, "#%02x%02x%02x", rgb[0], rgb[1], rgb[2]);
+}
+
+/* Format the color for a bin with COUNT points, relative to MAX. */
+static void density_color(config *cfg, uint64_t count, uint64_t max, char buf[8]) {
+    double t = (double)count / max;
+    if (cfg->log_count) {
+        t = (max > 1 ? scale_log(count) / scale_log(max) : 1);
+    }
+    heat_color(t, buf);
+}
+
+/* Sum every column's counts into square bins of cfg->heat_bin pixels,
+ * and draw one rectangle per non-empty bin, colored by its count
+ * relative to the densest bin. */
+static void plot_heat(config *cfg, plot_info *pi, uint8_t columns) {
+    size_t bin = cfg->heat_bin;
+    size_t bins_w = (pi->w + bin - 1) / bin;
+    size_t bins_h = (pi->h + bin - 1) / bin;
+    uint64_t *bins = calloc(bins_w * bins_h, sizeof(*bins));
+    if (bins == NULL) { err(1, "calloc"); }
+
+    for (uint8_t c = 0; c < columns; c++) {
+        size_t pos = 0;
+        counter_cell cell;
+        while (counter_next(pi->counters[c], &pos, &cell)) {
+            bins[(cell.y / bin) * bins_w + cell.x / bin] += cell.count;
+        }
+    }
+
+    uint64_t max = 0;
+    for (size_t i = 0; i < bins_w * bins_h; i++) {
+        if (bins[i] > max) { max = bins[i]; }
+    }
+
+    for (size_t by = 0; by < bins_h; by++) {
+        for (size_t bx = 0; bx < bins_w; bx++) {
+            uint64_t count = bins[by * bins_w + bx];
+            if (count == 0) { continue; }
+            char color[8];
+            density_color(cfg, count, max, color);
+
+            size_t x = bx * bin;
+            size_t y = by * bin;
+            size_t w = (x + bin > pi->w ? pi->w - x : bin);
+            size_t h = (y + bin > pi->h ? pi->h - y : bin);
+            svg_printf_rect(x, y, w, h, color);
+        }
+    }
+    free(bins);
+}
+
+/* Sum every column's counts into hexes cfg->heat_bin pixels across,
+ * and draw one hexagon per non-empty hex, colored like a heat map. */
+static void plot_hexes(config *cfg, plot_info *pi, uint8_t columns) {
+    hex_grid g = { .counts = NULL };
+    hexbin_init(&g, pi->w, pi->h, cfg->heat_bin);
+    hexbin_count(&g, pi, columns);
+
+    double half_w, top, side;
+    hexbin_corners(&g, &half_w, &top, &side);
+    for (size_t row = 0; row < g.rows; row++) {
+        for (size_t col = 0; col < g.cols; col++) {
+            uint64_t count = g.counts[row * g.cols + col];
+            if (count == 0) { continue; }
+            char color[8];
+            density_color(cfg, count, g.max, color);
+
+            double x, y;
+            hexbin_center(&g, col, row, &x, &y);
+            svg_printf_hex(x, y, half_w, top, side, color);
+        }
+    }
+    hexbin_free(&g);
+}
+
+/* Draw the modes that combine every column into one set of bins. */
+static bool plot_bins(config *cfg, plot_info *pi, uint8_t columns) {
+    switch (cfg->mode) {
+    case MODE_HEAT: plot_heat(cfg, pi, columns); return true;
+    case MODE_HEX: plot_hexes(cfg, pi, columns); return true;
+    default: return false;
+    }
+}
+
+int svg_plot(config *cfg, plot_info *pi, data_set *ds) {
+    begin_plot(cfg, pi, ds->columns);
+    bool binned = plot_bins(cfg, pi, ds->columns);
+
+    pixel_bitmap drawn = { .bits = NULL };
+    if (!binned && !pi->counters && cfg->mode == MODE_DOT) {
+        bitmap_init(&drawn, pi->w, pi->h);
+    }
+
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        if (!binned) {
+            if (drawn.bits && c > 0) { bitmap_clear(&drawn); }
+            if (pi->counters) {
+                plot_counts(cfg, pi, c);
+            } else if (cfg->svg_compact) {
+                plot_points_compact(cfg, pi, ds, c, &drawn);
+            } else {
+                plot_points(cfg, pi, ds, c, &drawn);
             }
         }
 
@@ -75,11 +562,22 @@ int svg_plot(config *cfg, plot_info *pi, data_set *ds) {
             double slope = 0;
             double intercept = 0;
             
-            regression(column, ds->rows, transform, &slope, &intercept);
-            svg_printf_regression_line(pi, color, slope, intercept);
+            regression(DS_XS(ds, c), DS_YS(ds, c), ds->rows,
+                scale_get_plot_transform(pi), &slope, &intercept);
+            svg_printf_regression_line(pi, get_color(c, cfg->svg_theme), slope, intercept);
         }
     }
 
+    free(drawn.bits);
+    svg_printf_end();
+    return 0;
+}
+
+int svg_plot_counts(config *cfg, plot_info *pi, uint8_t columns) {
+    begin_plot(cfg, pi, columns);
+    if (!plot_bins(cfg, pi, columns)) {
+        for (uint8_t c = 0; c < columns; c++) { plot_counts(cfg, pi, c); }
+    }
     svg_printf_end();
     return 0;
 }
@@ -93,37 +591,125 @@ static char *get_color(uint8_t column, svg_theme *theme) {
 }
 
 static void svg_printf_header(size_t w, size_t h) {
-    printf("<svg xmlns=\"http://www.w3.org/2000/svg\" "
-           "width=\"%zu\" height=\"%zu\" version=\"1.1\">\n",
-        w, h);
-    printf("<!-- Generator: guff %u.%u.%u -->\n",
-        GUFF_VERSION_MAJOR, GUFF_VERSION_MINOR, GUFF_VERSION_PATCH);
+    emit_str("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"");
+    emit_uint(w);
+    emit_str("\" height=\"");
+    emit_uint(h);
+    emit_str("\" version=\"1.1\">\n<!-- Generator: guff ");
+    emit_uint(GUFF_VERSION_MAJOR);
+    emit_str(".");
+    emit_uint(GUFF_VERSION_MINOR);
+    emit_str(".");
+    emit_uint(GUFF_VERSION_PATCH);
+    emit_str(" -->\n");
 }
 
 static void svg_printf_frame(size_t w, size_t h, char *fill_color,
         size_t border_width, char *border_color) {
-    printf("<rect x=\"0\" y=\"0\" width=\"%zu\" height=\"%zu\"\n",
-        w, h);
-    printf("    fill=\"%s\" stroke-width=\"%zu\" stroke=\"%s\" />\n",
-        fill_color, border_width, border_color);
+    emit_str("<rect x=\"0\" y=\"0\" width=\"");
+    emit_uint(w);
+    emit_str("\" height=\"");
+    emit_uint(h);
+    emit_str("\"\n    fill=\"");
+    emit_str(fill_color);
+    emit_str("\" stroke-width=\"");
+    emit_uint(border_width);
+    emit_str("\" stroke=\"");
+    emit_str(border_color);
+    emit_str("\" />\n");
 }
 
 static void svg_printf_begin_polyline(void) {
-    printf("<polyline points=\"\n");
+    emit_str("<polyline points=\"\n");
 }
 
 static void svg_printf_polyline_point(size_t x, size_t y) {
-    printf("    %zu,%zu\n", x, y);
+    emit_str("    ");
+    emit_uint(x);
+    emit_str(",");
+    emit_uint(y);
+    emit_str("\n");
 }
 
 static void svg_printf_end_polyline(char *color, size_t line_width) {
-    printf("\" stroke=\"%s\" stroke-width=\"%zu\" fill=\"none\" />\n",
-        color, line_width);
+    emit_str("\" stroke=\"");
+    emit_str(color);
+    emit_str("\" stroke-width=\"");
+    emit_uint(line_width);
+    emit_str("\" fill=\"none\" />\n");
 }
 
 static void svg_printf_circle(size_t x, size_t y, size_t point_size, char *color) {
-    printf("<circle cx=\"%zu\" cy=\"%zu\" r=\"%zu\" stroke=\"%s\" />\n",
-        x, y, point_size, color);
+    emit_str("<circle cx=\"");
+    emit_uint(x);
+    emit_str("\" cy=\"");
+    emit_uint(y);
+    emit_str("\" r=\"");
+    emit_uint(point_size);
+    emit_str("\" stroke=\"");
+    emit_str(color);
+    emit_str("\" />\n");
+}
+
+/* A circle styled by column C's CSS class, for compact mode. */
+static void svg_printf_class_circle(size_t x, size_t y, size_t point_size, uint8_t c) {
+    emit_str("<circle class=\"c");
+    emit_uint(c);
+    emit_str("\" cx=\"");
+    emit_uint(x);
+    emit_str("\" cy=\"");
+    emit_uint(y);
+    emit_str("\" r=\"");
+    emit_uint(point_size);
+    emit_str("\"/>\n");
+}
+
+static void svg_printf_rect(size_t x, size_t y, size_t w, size_t h, char *color) {
+    emit_str("<rect x=\"");
+    emit_uint(x);
+    emit_str("\" y=\"");
+    emit_uint(y);
+    emit_str("\" width=\"");
+    emit_uint(w);
+    emit_str("\" height=\"");
+    emit_uint(h);
+    emit_str("\" fill=\"");
+    emit_str(color);
+    emit_str("\" />\n");
+}
+
+static void svg_printf_hex(double x, double y, double half_w, double top, double side, char *color) {
+    const double corners[][2] = {
+        { x, y - top }, { x + half_w, y - side }, { x + half_w, y + side },
+        { x, y + top }, { x - half_w, y + side }, { x - half_w, y - side },
+    };
+    emit_str("<polygon points=\"");
+    for (size_t i = 0; i < 6; i++) {
+        if (i > 0) { emit_str(" "); }
+        emit_fixed1(corners[i][0]);
+        emit_str(",");
+        emit_fixed1(corners[i][1]);
+    }
+    emit_str("\" fill=\"");
+    emit_str(color);
+    emit_str("\" />\n");
+}
+
+static void svg_printf_line(int64_t x1, int64_t y1, int64_t x2, int64_t y2,
+        char *color, size_t width, bool dashed) {
+    emit_str("<line x1=\"");
+    emit_int(x1);
+    emit_str("\" y1=\"");
+    emit_int(y1);
+    emit_str("\" x2=\"");
+    emit_int(x2);
+    emit_str("\" y2=\"");
+    emit_int(y2);
+    emit_str("\" stroke=\"");
+    emit_str(color);
+    emit_str("\" stroke-width=\"");
+    emit_uint(width);
+    emit_str(dashed ? "\" stroke-dasharray=\"2,5\" />\n" : "\" />\n");
 }
 
 static double scale_tick(size_t width, double range) {
@@ -133,14 +719,39 @@ static double scale_tick(size_t width, double range) {
     return width * (step / range);
 }
 
-static void svg_printf_axis(plot_info *pi, svg_theme *theme) {
+/* Draw an axis tick, or in compact mode add it to the TICKS path. */
+static void svg_printf_tick(svg_theme *theme, svg_path *ticks,
+        int x0, int y0, int x1, int y1) {
+    if (ticks) {
+        svg_printf_path_break(ticks);
+        svg_printf_path_point(ticks, x0, y0);
+        svg_printf_path_point(ticks, x1, y1);
+    } else {
+        svg_printf_line(x0, y0, x1, y1, theme->axis_color, 1, false);
+    }
+}
+
+static void svg_printf_x_axis(plot_info *pi, svg_theme *theme) {
+    svg_printf_line(0, pi->axis_y, pi->w, pi->axis_y,
+        theme->axis_color, theme->axis_width, !pi->draw_x_axis);
+}
+
+static void svg_printf_axis(config *cfg, plot_info *pi) {
+    svg_theme *theme = cfg->svg_theme;
     int tick_w = 3*theme->axis_width;
+    svg_path path;
+    svg_path *ticks = NULL;
 
     // Y axis
-    printf("<line x1=\"%zu\" y1=\"%d\" x2=\"%zu\" y2=\"%zu\" "
-        "stroke=\"%s\" stroke-width=\"%u\" %s/>\n",
-        pi->axis_x, 0, pi->axis_x, pi->h,
-        theme->axis_color, theme->axis_width, pi->draw_y_axis ? "" : "stroke-dasharray=\"2,5\" ");
+    svg_printf_line(pi->axis_x, 0, pi->axis_x, pi->h,
+        theme->axis_color, theme->axis_width, !pi->draw_y_axis);
+
+    if (cfg->svg_compact) {
+        // draw the X axis first, so all the ticks can be one path
+        svg_printf_x_axis(pi, theme);
+        svg_printf_begin_path(&path, "t", -1);
+        ticks = &path;
+    }
 
     // X axis ticks
     if (pi->draw_x_axis) {
@@ -149,22 +760,15 @@ static void svg_printf_axis(plot_info *pi, svg_theme *theme) {
 
         double xto = scale_tick(pi->w, pi->range_x);
         for (int wx = pi->axis_x + xto; wx < pi->w; wx += xto) {
-            printf("<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" "
-                "stroke=\"%s\" stroke-width=\"1\" />\n",
-                wx, y0, wx, y1, theme->axis_color);
+            svg_printf_tick(theme, ticks, wx, y0, wx, y1);
         }
         for (int wx = pi->axis_x - xto; wx > 0; wx -= xto) {
-            printf("<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" "
-                "stroke=\"%s\" stroke-width=\"1\" />\n",
-                wx, y0, wx, y1, theme->axis_color);
+            svg_printf_tick(theme, ticks, wx, y0, wx, y1);
         }
     }
 
     // X axis
-    printf("<line x1=\"%zu\" y1=\"%zu\" x2=\"%zu\" y2=\"%zu\" "
-        "stroke=\"%s\" stroke-width=\"%u\" %s/>\n",
-        0L, pi->axis_y, pi->w, pi->axis_y,
-        theme->axis_color, theme->axis_width, pi->draw_x_axis ? "" : "stroke-dasharray=\"2,5\" ");
+    if (!cfg->svg_compact) { svg_printf_x_axis(pi, theme); }
 
     // Y axis ticks
     if (pi->draw_y_axis) {
@@ -174,20 +778,19 @@ static void svg_printf_axis(plot_info *pi, svg_theme *theme) {
 
         double yto = scale_tick(pi->h, pi->range_y);
         for (int hy = pi->axis_y + yto; hy < pi->h; hy += yto) {
-            printf("<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" "
-                "stroke=\"%s\" stroke-width=\"1\" />\n",
-                x0, hy, x1, hy, theme->axis_color);
+            svg_printf_tick(theme, ticks, x0, hy, x1, hy);
         }
         for (int hy = pi->axis_y - yto; hy > 0; hy -= yto) {
-            printf("<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" "
-                "stroke=\"%s\" stroke-width=\"1\" />\n",
-                x0, hy, x1, hy, theme->axis_color);
+            svg_printf_tick(theme, ticks, x0, hy, x1, hy);
         }
     }
+
+    if (ticks) { svg_printf_end_path(ticks); }
 }
 
 static void svg_printf_end(void) {
-    printf("</svg>\n");
+    emit_str("</svg>\n");
+    emit_flush();
 }
 
 static void svg_printf_regression_line(plot_info *pi, char *color,
@@ -206,7 +809,5 @@ static void svg_printf_regression_line(plot_info *pi, char *color,
     LOG(2, "p0: (%g, %g) => [%d, %d]\n", p0.x, p0.y, sp0.x, sp0.y);
     LOG(2, "p1: (%g, %g) => [%d, %d]\n", p1.x, p1.y, sp1.x, sp1.y);
 
-    printf("<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" "
-        "stroke=\"%s\" stroke-width=\"%u\" stroke-dasharray=\"2,5\" />\n",
-        sp0.x, sp0.y, sp1.x, sp1.y, color, REGRESSION_LINE_WIDTH);
+    svg_printf_line(sp0.x, sp0.y, sp1.x, sp1.y, color, REGRESSION_LINE_WIDTH, true);
 }
@@ -19,4 +19,9 @@ typedef struct svg_theme {
 
 int svg_plot(config *cfg, plot_info *pi, data_set *ds);
 
+/* Plot COLUMNS columns' points from their counts in pi->counters,
+ * rather than from a data_set. Lines and regressions need the points
+ * themselves, so this only handles dot, count, and heat modes. */
+int svg_plot_counts(config *cfg, plot_info *pi, uint8_t columns);
+
 #endif
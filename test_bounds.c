@@ -0,0 +1,125 @@
+#include "test_guff.h"
+
+#include "bounds.h"
+#include "parallel.h"
+
+#define MAX_ROWS (700 * 1000)
+#define COLUMNS 3
+
+static double *xs;
+static double *ys[COLUMNS];
+
+static void setup_cb(void *data) {
+    xs = malloc(MAX_ROWS * sizeof(*xs));
+    assert(xs);
+    for (size_t c = 0; c < COLUMNS; c++) {
+        ys[c] = malloc(MAX_ROWS * sizeof(*ys[c]));
+        assert(ys[c]);
+    }
+}
+
+static void teardown_cb(void *data) {
+    free(xs);
+    for (size_t c = 0; c < COLUMNS; c++) { free(ys[c]); }
+    parallel_set_threads(0);
+}
+
+/* Fill the columns with values in [-1000, 1000), about 1 in 8 empty. */
+static void fill(uint64_t seed, size_t rows) {
+    uint64_t state = seed;
+    for (size_t r = 0; r < rows; r++) {
+        xs[r] = (prng(&state) % 8 == 0 ? EMPTY_VALUE
+            : (int32_t)(prng(&state) % 2000000) / 1000.0 - 1000);
+        for (size_t c = 0; c < COLUMNS; c++) {
+            ys[c][r] = (prng(&state) % 8 == 0 ? EMPTY_VALUE
+                : (int32_t)(prng(&state) % 2000000) / 1000.0 - 1000);
+        }
+    }
+}
+
+/* The bounds, as draw_calc_bounds used to find them. */
+static bool ref_bounds(const data_set *ds, point *min, point *max) {
+    bool found = false;
+    for (uint8_t c = 0; c < ds->columns; c++) {
+        for (size_t r = 0; r < ds->rows; r++) {
+            point p = DS_POINT(ds, c, r);
+            if (IS_EMPTY_POINT((&p))) { continue; }
+            if (!found || p.x < min->x) { min->x = p.x; }
+            if (!found || p.x > max->x) { max->x = p.x; }
+            if (!found || p.y < min->y) { min->y = p.y; }
+            if (!found || p.y > max->y) { max->y = p.y; }
+            found = true;
+        }
+    }
+    return found;
+}
+
+static greatest_test_res matches_reference(size_t rows, bool flip) {
+    data_set ds = {
+        .columns = COLUMNS, .rows = rows, .flip_xy = flip,
+        .xs = xs, .ys = ys,
+    };
+    point exp_min, exp_max, min, max;
+    ASSERT(ref_bounds(&ds, &exp_min, &exp_max));
+    ASSERT(bounds_scan(&ds, &min, &max));
+    ASSERT_EQUAL_T(&exp_min, &min, type_point, NULL);
+    ASSERT_EQUAL_T(&exp_max, &max, type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(bounds_match_reference) {
+    uint64_t seed = 1;
+    // odd sizes, so the tail after the last full vector is exercised
+    for (size_t rows = 1; rows < 40; rows++) {
+        fill(seed++, rows);
+        xs[0] = 1;              // at least one complete point
+        ys[0][0] = 1;
+        CHECK_CALL(matches_reference(rows, false));
+        CHECK_CALL(matches_reference(rows, true));
+    }
+    PASS();
+}
+
+DEF_TEST(bounds_split_across_threads) {
+    parallel_set_threads(4);
+    fill(23, MAX_ROWS);
+    // extremes near the ends of the first and last chunks
+    xs[3] = -5000;
+    ys[2][MAX_ROWS - 2] = 9000;
+    xs[MAX_ROWS - 2] = 1;
+    CHECK_CALL(matches_reference(MAX_ROWS, false));
+    CHECK_CALL(matches_reference(MAX_ROWS, true));
+    PASS();
+}
+
+DEF_TEST(bounds_skip_incomplete_points) {
+    double x[] = { EMPTY_VALUE, 1, 2, 30 };
+    double y0[] = { 100, EMPTY_VALUE, 5, 6 };
+    double *y[] = { y0 };
+    data_set ds = { .columns = 1, .rows = 4, .xs = x, .ys = y };
+
+    point min, max;
+    ASSERT(bounds_scan(&ds, &min, &max));
+    point exp_min = { .x = 2, .y = 5 };
+    point exp_max = { .x = 30, .y = 6 };
+    ASSERT_EQUAL_T(&exp_min, &min, type_point, NULL);
+    ASSERT_EQUAL_T(&exp_max, &max, type_point, NULL);
+
+    // with no complete points, the bounds are left alone
+    x[2] = x[3] = EMPTY_VALUE;
+    point unchanged = { .x = 123, .y = 456 };
+    min = max = unchanged;
+    ASSERT_FALSE(bounds_scan(&ds, &min, &max));
+    ASSERT_EQUAL_T(&unchanged, &min, type_point, NULL);
+    ASSERT_EQUAL_T(&unchanged, &max, type_point, NULL);
+    PASS();
+}
+
+SUITE(s_bounds) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(bounds_match_reference);
+    RUN_TEST(bounds_split_across_threads);
+    RUN_TEST(bounds_skip_incomplete_points);
+}
@@ -0,0 +1,209 @@
+#include "test_guff.h"
+
+#include "counter.h"
+
+static counter *c;
+
+static void setup_cb(void *data) {
+    c = NULL;
+}
+
+static void teardown_cb(void *data) {
+    counter_free(c);
+}
+
+static greatest_test_res counts_points(size_t w, size_t h, size_t rows) {
+    c = counter_init(w, h, rows);
+    ASSERT(c);
+
+    counter_increment(c, 3, 4);
+    counter_increment(c, 3, 4);
+    counter_increment(c, 4, 3);
+    counter_increment(c, 0, 0);
+    ASSERT_EQ(2, counter_get(c, 3, 4));
+    ASSERT_EQ(1, counter_get(c, 4, 3));
+    ASSERT_EQ(1, counter_get(c, 0, 0));
+    ASSERT_EQ(0, counter_get(c, 5, 5));
+
+    // off the plot, including negative coordinates cast to size_t
+    counter_increment(c, w, 0);
+    counter_increment(c, 0, h);
+    counter_increment(c, (size_t)-1, 2);
+    ASSERT_EQ(0, counter_get(c, w, 0));
+    ASSERT_EQ(0, counter_get(c, 0, h));
+    ASSERT_EQ(0, counter_get(c, (size_t)-1, 2));
+
+    counter *same = counter_reset(c, w, h, rows);
+    ASSERT_EQ(c, same);
+    ASSERT_EQ(0, counter_get(c, 3, 4));
+    PASS();
+}
+
+DEF_TEST(counter_dense) {
+    CHECK_CALL(counts_points(72, 40, 1000 * 1000));
+    PASS();
+}
+
+DEF_TEST(counter_sparse_for_huge_plot) {
+    CHECK_CALL(counts_points(50 * 1000, 50 * 1000, 100));
+    PASS();
+}
+
+DEF_TEST(counter_reset_resizes) {
+    c = counter_init(72, 40, 10);
+    ASSERT(c);
+    counter_increment(c, 1, 1);
+
+    c = counter_reset(c, 640, 480, 10);
+    ASSERT(c);
+    ASSERT_EQ(0, counter_get(c, 1, 1));
+    counter_increment(c, 600, 400);
+    ASSERT_EQ(1, counter_get(c, 600, 400));
+    PASS();
+}
+
+DEF_TEST(counter_sparse_grows) {
+    const size_t w = 20000, h = 20000;
+    c = counter_init(w, h, 10);
+    ASSERT(c);
+
+    counter_stats stats;
+    counter_get_stats(c, &stats);
+    size_t initial = stats.capacity;
+
+    // many distinct points, with the first third counted twice
+    const size_t points = 100000;
+    uint64_t state = 7;
+    for (size_t i = 0; i < points; i++) {
+        size_t x = prng(&state) % w;
+        size_t y = prng(&state) % h;
+        counter_increment(c, x, y);
+        if (i < points / 3) { counter_increment(c, x, y); }
+    }
+
+    counter_get_stats(c, &stats);
+    ASSERT(stats.capacity > initial);
+    ASSERT(stats.load <= 0.75);
+    ASSERT(stats.used > points - 100);   // allow a few collisions
+    ASSERT(stats.mean_probe < 2.0);
+
+    state = 7;
+    for (size_t i = 0; i < points; i++) {
+        size_t x = prng(&state) % w;
+        size_t y = prng(&state) % h;
+        ASSERT(counter_get(c, x, y) >= (i < points / 3 ? 2 : 1));
+    }
+    PASS();
+}
+
+/* Counting points in two counters and merging them should give the
+ * same counts as counting them all in one. */
+static greatest_test_res merge_matches_single(bool dense_dst, bool dense_src) {
+    // large enough that ROWS decides whether each is dense
+    const size_t w = 4200, h = 4000;
+    const size_t dense_rows = 10 * 1000 * 1000, sparse_rows = 10;
+    counter *dst = counter_init(w, h, dense_dst ? dense_rows : sparse_rows);
+    counter *src = counter_init(w, h, dense_src ? dense_rows : sparse_rows);
+    counter *all = counter_init(w, h, sparse_rows);
+    ASSERT(dst && src && all);
+
+    const size_t points = 20000;
+    uint64_t state = 13;
+    for (size_t i = 0; i < points; i++) {
+        // a narrow band, so many points land on the same pixels
+        size_t x = prng(&state) % w;
+        size_t y = prng(&state) % 20;
+        counter_increment(i % 3 == 0 ? src : dst, x, y);
+        counter_increment(all, x, y);
+    }
+
+    counter_merge(dst, src);
+
+    state = 13;
+    for (size_t i = 0; i < points; i++) {
+        size_t x = prng(&state) % w;
+        size_t y = prng(&state) % 20;
+        ASSERT_EQ_FMT(counter_get(all, x, y), counter_get(dst, x, y), "%zu");
+    }
+    counter_stats merged, single;
+    counter_get_stats(dst, &merged);
+    counter_get_stats(all, &single);
+    ASSERT_EQ_FMT(single.used, merged.used, "%zu");
+
+    counter_free(dst);
+    counter_free(src);
+    counter_free(all);
+    PASS();
+}
+
+DEF_TEST(counter_merge_dense_and_sparse) {
+    CHECK_CALL(merge_matches_single(true, true));
+    CHECK_CALL(merge_matches_single(true, false));
+    CHECK_CALL(merge_matches_single(false, true));
+    CHECK_CALL(merge_matches_single(false, false));
+    PASS();
+}
+
+/* Every occupied cell should come up once, in row-major order. */
+static greatest_test_res visits_occupied_cells(size_t w, size_t h, size_t rows) {
+    c = counter_init(w, h, rows);
+    ASSERT(c);
+    size_t pos = 0;
+    counter_cell cell;
+    ASSERT_FALSE(counter_next(c, &pos, &cell));
+
+    const size_t points = 5000;
+    uint64_t state = 19;
+    for (size_t i = 0; i < points; i++) {
+        counter_increment(c, prng(&state) % w, prng(&state) % 50);
+    }
+
+    size_t total = 0, cells = 0;
+    size_t prev = 0;
+    pos = 0;
+    while (counter_next(c, &pos, &cell)) {
+        size_t key = cell.y * w + cell.x;
+        ASSERT(cells == 0 || key > prev);
+        ASSERT(cell.count > 0);
+        ASSERT_EQ_FMT(counter_get(c, cell.x, cell.y), cell.count, "%zu");
+        prev = key;
+        total += cell.count;
+        cells++;
+    }
+    ASSERT_EQ_FMT(points, total, "%zu");
+
+    counter_stats stats;
+    counter_get_stats(c, &stats);
+    ASSERT_EQ_FMT(stats.used, cells, "%zu");
+    PASS();
+}
+
+DEF_TEST(counter_next_dense) {
+    CHECK_CALL(visits_occupied_cells(640, 480, 5000));
+    PASS();
+}
+
+DEF_TEST(counter_next_sparse) {
+    CHECK_CALL(visits_occupied_cells(50 * 1000, 50 * 1000, 10));
+    PASS();
+}
+
+DEF_TEST(counter_too_large) {
+    c = counter_init(100 * 1000, 100 * 1000, 10);
+    ASSERT_EQ(NULL, c);
+    PASS();
+}
+
+SUITE(s_counter) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(counter_dense);
+    RUN_TEST(counter_sparse_for_huge_plot);
+    RUN_TEST(counter_reset_resizes);
+    RUN_TEST(counter_sparse_grows);
+    RUN_TEST(counter_merge_dense_and_sparse);
+    RUN_TEST(counter_next_dense);
+    RUN_TEST(counter_next_sparse);
+    RUN_TEST(counter_too_large);
+}
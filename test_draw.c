@@ -3,6 +3,10 @@
 #include "draw.h"
 #include "input.h"
 #include "input_internal.h"
+#include "counter.h"
+#include "parallel.h"
+
+#define COUNT_MAX_COLUMNS 10
 
 static data_set ds;
 static plot_info pi;
@@ -206,6 +210,52 @@ DEF_TEST(bounds_log_distant) {
     PASS();
 }
 
+DEF_TEST(bounds_pinned) {
+    config cfg = {
+        .x_column = true,
+    };
+    char *lines[] = {
+        "5 50",
+        "15 150",
+    };
+    READ_LINES_AND_INIT_PI(cfg, lines);
+    pi.pin_x = (axis_pin){ .pinned = true, .min = 10, .max = 20 };
+
+    draw_calc_bounds(&ds, &pi);
+    // pinned bounds aren't stretched to include the axis
+    ASSERT_IN_RANGE(10, pi.min_x, 0.0001);
+    ASSERT_IN_RANGE(20, pi.max_x, 0.0001);
+    ASSERT_IN_RANGE(10, pi.range_x, 0.0001);
+
+    ASSERT_IN_RANGE(0, pi.min_y, 0.0001);
+    ASSERT_IN_RANGE(150, pi.max_y, 0.0001);
+    PASS();
+}
+
+DEF_TEST(bounds_pinned_log) {
+    config cfg = {
+        .log_y = true,
+    };
+    char *lines[] = {
+        "10",
+        "100",
+    };
+    READ_LINES_AND_INIT_PI(cfg, lines);
+    pi.pin_y = (axis_pin){ .pinned = true, .min = 1, .max = 1000 };
+
+    draw_calc_bounds(&ds, &pi);
+    ASSERT_IN_RANGE(0, pi.min_y, 0.0001);
+    ASSERT_IN_RANGE(/* log(1000) */ 6.9078, pi.max_y, 0.0001);
+
+    // likewise without any points, as for streaming rasterization
+    pi.pin_x = (axis_pin){ .pinned = true, .min = -1, .max = 1 };
+    draw_calc_pinned_bounds(&pi);
+    ASSERT_IN_RANGE(-1, pi.min_x, 0.0001);
+    ASSERT_IN_RANGE(1, pi.max_x, 0.0001);
+    ASSERT_IN_RANGE(6.9078, pi.range_y, 0.0001);
+    PASS();
+}
+
 DEF_TEST(reject_x_range_of_zero) {
     config cfg;
     memset(&cfg, 0, sizeof(cfg));
@@ -233,6 +283,61 @@ DEF_TEST(reject_y_range_of_zero) {
     PASS();
 }
 
+/* Counting on several threads, split by column and then by rows,
+ * should give exactly the counts of counting serially. */
+static greatest_test_res count_matches_serial(uint8_t columns, size_t rows) {
+    double *cols[COUNT_MAX_COLUMNS];
+    uint64_t state = 17;
+    for (uint8_t c = 0; c < columns; c++) {
+        cols[c] = malloc(rows * sizeof(double));
+        assert(cols[c]);
+        for (size_t r = 0; r < rows; r++) {
+            // clustered, with some empty
+            cols[c][r] = (prng(&state) % 16 == 0 ? EMPTY_VALUE
+                : (prng(&state) % 1000) * (prng(&state) % 1000) / 1000.0);
+        }
+    }
+    double *xs = malloc(rows * sizeof(double));
+    assert(xs);
+    for (size_t r = 0; r < rows; r++) { xs[r] = r; }
+    data_set cds = { .columns = columns, .rows = rows, .xs = xs, .ys = cols };
+    plot_info cpi = { .w = 640, .h = 480 };
+    draw_calc_bounds(&cds, &cpi);
+
+    config serial = { .mode = MODE_COUNT };
+    config threaded = { .mode = MODE_COUNT };
+    parallel_set_threads(1);
+    draw_count(&serial, &cpi, &cds);
+    parallel_set_threads(8);
+    draw_count(&threaded, &cpi, &cds);
+    ASSERTm("should have split rows", columns > 1 || threaded.partial_counter_count > 0);
+
+    for (uint8_t c = 0; c < columns; c++) {
+        for (size_t y = 0; y < cpi.h; y++) {
+            for (size_t x = 0; x < cpi.w; x++) {
+                ASSERT_EQ_FMT(counter_get(serial.counters[c], x, y),
+                    counter_get(threaded.counters[c], x, y), "%zu");
+            }
+        }
+    }
+
+    draw_close(&serial);
+    draw_close(&threaded);
+    parallel_set_threads(0);
+    free(xs);
+    for (uint8_t c = 0; c < columns; c++) { free(cols[c]); }
+    PASS();
+}
+
+DEF_TEST(count_parallel_matches_serial) {
+    CHECK_CALL(count_matches_serial(1, 2 * 1000 * 1000));
+    CHECK_CALL(count_matches_serial(3, 600 * 1000));
+    CHECK_CALL(count_matches_serial(COUNT_MAX_COLUMNS, 600 * 1000));
+    // too small to be worth counting on several threads
+    CHECK_CALL(count_matches_serial(3, 20 * 1000));
+    PASS();
+}
+
 SUITE(s_draw) {
     SET_SETUP(setup_cb, NULL);
     SET_TEARDOWN(teardown_cb, NULL);
@@ -246,7 +351,11 @@ SUITE(s_draw) {
     RUN_TEST(bounds_too_distant_to_touch_axis);
     RUN_TEST(bounds_log_basic);
     RUN_TEST(bounds_log_distant);
+    RUN_TEST(bounds_pinned);
+    RUN_TEST(bounds_pinned_log);
 
     RUN_TEST(reject_x_range_of_zero);
     RUN_TEST(reject_y_range_of_zero);
+
+    RUN_TEST(count_parallel_matches_serial);
 }
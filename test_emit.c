@@ -0,0 +1,122 @@
+#include "test_guff.h"
+
+#include "emit.h"
+
+static void setup_cb(void *data) {
+}
+
+static void teardown_cb(void *data) {
+}
+
+#define OUT_SIZE (256 * 1024)
+
+static char got[OUT_SIZE];
+static char want[OUT_SIZE];
+static size_t want_len;
+
+/* Start capturing stdout in a temporary file. */
+static FILE *begin_capture(int *saved) {
+    fflush(stdout);
+    FILE *tmp = tmpfile();
+    assert(tmp);
+    *saved = dup(STDOUT_FILENO);
+    dup2(fileno(tmp), STDOUT_FILENO);
+    want_len = 0;
+    return tmp;
+}
+
+/* Flush the emitter, stop capturing, and read what was written. */
+static void end_capture(FILE *tmp, int saved) {
+    emit_flush();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    rewind(tmp);
+    size_t len = fread(got, 1, OUT_SIZE - 1, tmp);
+    got[len] = '\0';
+    fclose(tmp);
+}
+
+#define EXPECT(...)                                                     \
+    want_len += snprintf(&want[want_len], OUT_SIZE - want_len, __VA_ARGS__)
+
+DEF_TEST(emit_ints_match_printf) {
+    const int64_t examples[] = {
+        0, 1, -1, 9, 10, -10, 99, 100, 12345, -65536,
+        INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN,
+    };
+    int saved;
+    FILE *tmp = begin_capture(&saved);
+    for (size_t i = 0; i < sizeof(examples)/sizeof(examples[0]); i++) {
+        emit_int(examples[i]);
+        emit_str(" ");
+        EXPECT("%lld ", (long long)examples[i]);
+        if (examples[i] >= 0) {
+            emit_uint(examples[i]);
+            emit_str("\n");
+            EXPECT("%zu\n", (size_t)examples[i]);
+        }
+    }
+    emit_uint(SIZE_MAX);
+    EXPECT("%zu", (size_t)SIZE_MAX);
+    end_capture(tmp, saved);
+
+    ASSERT_STR_EQ(want, got);
+    PASS();
+}
+
+DEF_TEST(emit_fixed_matches_printf) {
+    const double examples[] = {
+        0, -0.0, 0.04, -0.04, 0.05, 0.15, 0.25, -0.25, 0.35, 0.95,
+        9.95, 99.95, 1.25, 2.5, 1e7 + 0.05, 1e8, 1e8 + 0.05, 1e20, -1e300,
+        INFINITY, -INFINITY, 123.456, 4.6188021535170058,
+    };
+    int saved;
+    FILE *tmp = begin_capture(&saved);
+    for (size_t i = 0; i < sizeof(examples)/sizeof(examples[0]); i++) {
+        emit_fixed1(examples[i]);
+        emit_str("\n");
+        EXPECT("%.1f\n", examples[i]);
+    }
+
+    uint64_t state = 5;
+    for (size_t i = 0; i < 10000; i++) {
+        // mostly SVG-sized coordinates, including exact tenths and halves
+        double v = (int32_t)prng(&state) / (double)(1 << (prng(&state) % 24));
+        if (i % 3 == 0) { v = (int)(prng(&state) % 20001) / 20.0 - 500; }
+        emit_fixed1(v);
+        emit_str(" ");
+        EXPECT("%.1f ", v);
+    }
+    end_capture(tmp, saved);
+
+    ASSERT_STR_EQ(want, got);
+    PASS();
+}
+
+DEF_TEST(emit_strings_longer_than_the_buffer) {
+    static char line[100 * 1024];
+    memset(line, 'x', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+
+    int saved;
+    FILE *tmp = begin_capture(&saved);
+    emit_str("<");
+    emit_str(line);
+    emit_uint(42);
+    emit_str(line + 1000);
+    EXPECT("<%s42%s", line, line + 1000);
+    end_capture(tmp, saved);
+
+    ASSERT_EQ_FMT(want_len, strlen(got), "%zu");
+    ASSERT(0 == strcmp(want, got));
+    PASS();
+}
+
+SUITE(s_emit) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(emit_ints_match_printf);
+    RUN_TEST(emit_fixed_matches_printf);
+    RUN_TEST(emit_strings_longer_than_the_buffer);
+}
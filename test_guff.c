@@ -3,11 +3,41 @@
 /* Add all the definitions that need to be in the test runner's main file. */
 GREATEST_MAIN_DEFS();
 
+/* Run FUN, and save whatever it printed to stdout in OUT. */
+int capture_stdout(int (*fun)(void *udata), void *udata, char *out, size_t size) {
+    fflush(stdout);
+    FILE *tmp = tmpfile();
+    assert(tmp);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(tmp), STDOUT_FILENO);
+
+    int res = fun(udata);
+
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    rewind(tmp);
+    size_t len = fread(out, 1, size - 1, tmp);
+    out[len] = '\0';
+    fclose(tmp);
+    return res;
+}
+
 int main(int argc, char **argv) {
     GREATEST_MAIN_BEGIN();      /* command-line arguments, initialization. */
     RUN_SUITE(s_input);
+    RUN_SUITE(s_parse);
+    RUN_SUITE(s_bounds);
+    RUN_SUITE(s_counter);
     RUN_SUITE(s_draw);
+    RUN_SUITE(s_emit);
+    RUN_SUITE(s_hexbin);
+    RUN_SUITE(s_raster);
     RUN_SUITE(s_regression);
     RUN_SUITE(s_scale);
+    RUN_SUITE(s_scan);
+    RUN_SUITE(s_simplify);
+    RUN_SUITE(s_svg);
+    RUN_SUITE(s_window);
     GREATEST_MAIN_END();        /* display results */
 }
@@ -6,11 +6,34 @@
 
 #define DEF_TEST(X) TEST X(void)
 
+SUITE(s_bounds);
+SUITE(s_counter);
 SUITE(s_draw);
+SUITE(s_emit);
+SUITE(s_hexbin);
 SUITE(s_input);
+SUITE(s_parse);
+SUITE(s_raster);
 SUITE(s_regression);
 SUITE(s_scale);
+SUITE(s_scan);
+SUITE(s_simplify);
+SUITE(s_svg);
+SUITE(s_window);
 
 extern greatest_type_info *type_point;
 
+/* The point plotted for column C, row R of a data_set. */
+#define DS_POINT(DS, C, R) ((point){ .x = DS_XS(DS, C)[R], .y = DS_YS(DS, C)[R] })
+
+/* Run FUN, and save whatever it printed to stdout in OUT, which has
+ * room for SIZE bytes. Returns FUN's result. */
+int capture_stdout(int (*fun)(void *udata), void *udata, char *out, size_t size);
+
+/* Deterministic LCG, so failures (and benchmark runs) are reproducible. */
+static inline uint32_t prng(uint64_t *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
 #endif
@@ -0,0 +1,95 @@
+#include "test_guff.h"
+
+#include "hexbin.h"
+#include "counter.h"
+
+static hex_grid g;
+
+static void setup_cb(void *data) {
+    memset(&g, 0, sizeof(g));
+}
+
+static void teardown_cb(void *data) {
+    hexbin_free(&g);
+}
+
+/* Squared distance from the center of pixel (X, Y) to a hex's center. */
+static double center_dist(size_t x, size_t y, size_t col, size_t row) {
+    double cx, cy;
+    hexbin_center(&g, col, row, &cx, &cy);
+    double dx = x + 0.5 - cx;
+    double dy = y + 0.5 - cy;
+    return dx * dx + dy * dy;
+}
+
+DEF_TEST(hexbin_cell_is_nearest_center) {
+    const size_t w = 60;
+    const size_t h = 45;
+    for (size_t width = 2; width <= 17; width++) {
+        hexbin_init(&g, w, h, width);
+        for (size_t y = 0; y < h; y++) {
+            for (size_t x = 0; x < w; x++) {
+                size_t col, row;
+                hexbin_cell(&g, x, y, &col, &row);
+                ASSERT(col < g.cols);
+                ASSERT(row < g.rows);
+
+                // compare against every hex, allowing for ties
+                double best = center_dist(x, y, col, row);
+                for (size_t r = 0; r < g.rows; r++) {
+                    for (size_t c = 0; c < g.cols; c++) {
+                        ASSERT(best <= center_dist(x, y, c, r) + 1e-9);
+                    }
+                }
+            }
+        }
+    }
+    PASS();
+}
+
+DEF_TEST(hexbin_count_keeps_every_point) {
+    const size_t w = 72;
+    const size_t h = 40;
+    counter *cs[2] = {
+        counter_init(w, h, 0),
+        counter_init(w, h, 0),
+    };
+    plot_info pi = { .w = w, .h = h, .counters = cs };
+
+    uint64_t state = 7;
+    uint64_t total = 0;
+    for (size_t i = 0; i < 5000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t x = (state >> 33) % w;
+        size_t y = (state >> 45) % h;
+        counter_increment(cs[i & 1], x, y);
+        total++;
+    }
+
+    hexbin_init(&g, w, h, 4);
+    hexbin_count(&g, &pi, 2);
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    for (size_t i = 0; i < g.rows * g.cols; i++) {
+        sum += g.counts[i];
+        if (g.counts[i] > max) { max = g.counts[i]; }
+    }
+    ASSERT_EQ_FMT((size_t)total, (size_t)sum, "%zu");
+    ASSERT_EQ_FMT((size_t)max, (size_t)g.max, "%zu");
+
+    // reusing the grid starts over
+    hexbin_init(&g, w, h, 6);
+    for (size_t i = 0; i < g.rows * g.cols; i++) { ASSERT_EQ(0, g.counts[i]); }
+
+    counter_free(cs[0]);
+    counter_free(cs[1]);
+    PASS();
+}
+
+SUITE(s_hexbin) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(hexbin_cell_is_nearest_center);
+    RUN_TEST(hexbin_count_keeps_every_point);
+}
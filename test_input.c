@@ -2,6 +2,9 @@
 
 #include "input.h"
 #include "input_internal.h"
+#include "parallel.h"
+#include "reader.h"
+#include "bounds.h"
 #include <math.h>
 
 static data_set ds;
@@ -16,7 +19,7 @@ static void teardown_cb(void *data) {
 }
 
 DEF_TEST(input_empty) {
-    init_pairs(&ds);
+    init_columns(&ds);
     char empty[] = "\n";
     ASSERT_EQ(SINK_LINE_EMPTY, sink_line(&empty_cfg, &ds, NULL, 0, 0));
     ASSERT_EQ(SINK_LINE_EMPTY, sink_line(&empty_cfg, &ds, empty, 1, 0));
@@ -24,7 +27,7 @@ DEF_TEST(input_empty) {
 }
 
 DEF_TEST(input_comment) {
-    init_pairs(&ds);
+    init_columns(&ds);
     char c1[] = "#a comment";
     char c2[] = "// a comment";
     ASSERT_EQ(SINK_LINE_COMMENT, sink_line(&empty_cfg, &ds, c1, strlen(c1), 0));
@@ -33,58 +36,58 @@ DEF_TEST(input_comment) {
 }
 
 DEF_TEST(input_single) {
-    init_pairs(&ds);
+    init_columns(&ds);
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "23", 2, 0));
     ASSERT_EQ(1, ds.columns);
 
     point exp = { .x = 0, .y = 23 };
-    ASSERT_EQUAL_T(&exp, &ds.pairs[0][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp, &DS_POINT(&ds, 0, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_pair) {
-    init_pairs(&ds);
+    init_columns(&ds);
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "23 24", 5, 0));
 
     ASSERT_EQ(2, ds.columns);
     point exp0 = { .x = 0, .y = 23 };
     point exp1 = { .x = 0, .y = 24 };
-    ASSERT_EQUAL_T(&exp0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1, &ds.pairs[1][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_floats) {
-    init_pairs(&ds);
-    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "99.9 999.999", 13, 0));
+    init_columns(&ds);
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "99.9 999.999", 12, 0));
 
     ASSERT_EQ(2, ds.columns);
     point exp0 = { .x = 0, .y = 99.9 };
     point exp1 = { .x = 0, .y = 999.999 };
-    ASSERT_EQUAL_T(&exp0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1, &ds.pairs[1][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_csv) {
-    init_pairs(&ds);
-    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "23,24", 15, 0));
+    init_columns(&ds);
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "23,24", 5, 0));
 
     ASSERT_EQ(2, ds.columns);
     ASSERT_EQ(1, ds.rows);
     point exp0 = { .x = 0, .y = 23 };
     point exp1 = { .x = 0, .y = 24 };
-    ASSERT_EQUAL_T(&exp0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1, &ds.pairs[1][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_tab) {
-    init_pairs(&ds);
+    init_columns(&ds);
 
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "23\t24", 5, 0));
 
@@ -92,29 +95,29 @@ DEF_TEST(input_tab) {
     ASSERT_EQ(1, ds.rows);
     point exp0 = { .x = 0, .y = 23 };
     point exp1 = { .x = 0, .y = 24 };
-    ASSERT_EQUAL_T(&exp0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1, &ds.pairs[1][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_exponent) {
-    init_pairs(&ds);
+    init_columns(&ds);
 
-    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "-24e-7,+50e5", 16, 0));
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "-24e-7,+50e5", 12, 0));
 
     ASSERT_EQ(2, ds.columns);
     ASSERT_EQ(1, ds.rows);
     point exp0 = { .x = 0, .y = -24e-7 };
     point exp1 = { .x = 0, .y = 5e6 };
-    ASSERT_EQUAL_T(&exp0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1, &ds.pairs[1][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_multiline) {
-    init_pairs(&ds);
+    init_columns(&ds);
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "23", 2, 0));
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "24", 2, 1));
 
@@ -122,14 +125,14 @@ DEF_TEST(input_multiline) {
     ASSERT_EQ(2, ds.rows);
     point exp0_0 = { .x = 0, .y = 23 };
     point exp1_0 = { .x = 1, .y = 24 };
-    ASSERT_EQUAL_T(&exp0_0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1_0, &ds.pairs[0][1], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_0, &DS_POINT(&ds, 0, 1), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_single_column_null) {
-    init_pairs(&ds);
+    init_columns(&ds);
     char *lines[] = {
         "1278",
         "377",
@@ -152,16 +155,16 @@ DEF_TEST(input_single_column_null) {
     point exp4 = { .x = 4, .y = EMPTY_VALUE };
     point exp5 = { .x = 5, .y = 93 };
 
-    ASSERT_EQUAL_T(&exp0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1, &ds.pairs[0][1], type_point, NULL);
-    ASSERT_EQUAL_T(&exp4, &ds.pairs[0][4], type_point, NULL);
-    ASSERT_EQUAL_T(&exp5, &ds.pairs[0][5], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 0, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp4, &DS_POINT(&ds, 0, 4), type_point, NULL);
+    ASSERT_EQUAL_T(&exp5, &DS_POINT(&ds, 0, 5), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_multiline_null) {
-    init_pairs(&ds);
+    init_columns(&ds);
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "1,2,3", 5, 0));
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "4,,6", 4, 1));
 
@@ -174,18 +177,18 @@ DEF_TEST(input_multiline_null) {
     point exp1_0 = { .x = 1, .y = 4 };
     point exp1_1 = { .x = 1, .y = NAN };
     point exp1_2 = { .x = 1, .y = 6 };
-    ASSERT_EQUAL_T(&exp0_0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_1, &ds.pairs[1][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_2, &ds.pairs[2][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1_0, &ds.pairs[0][1], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1_1, &ds.pairs[1][1], type_point, NULL);
-    ASSERT_EQUAL_T(&exp1_2, &ds.pairs[2][1], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_1, &DS_POINT(&ds, 1, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_2, &DS_POINT(&ds, 2, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_0, &DS_POINT(&ds, 0, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_1, &DS_POINT(&ds, 1, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_2, &DS_POINT(&ds, 2, 1), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_trailing_null) {
-    init_pairs(&ds);
+    init_columns(&ds);
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "1,2,3,", 6, 0));
 
     ASSERT_EQ(4, ds.columns);
@@ -195,16 +198,16 @@ DEF_TEST(input_trailing_null) {
     point exp0_2 = { .x = 0, .y = 3 };
     point exp0_3 = { .x = 0, .y = NAN };
 
-    ASSERT_EQUAL_T(&exp0_0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_1, &ds.pairs[1][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_2, &ds.pairs[2][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_3, &ds.pairs[3][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_1, &DS_POINT(&ds, 1, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_2, &DS_POINT(&ds, 2, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_3, &DS_POINT(&ds, 3, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(input_leading_null) {
-    init_pairs(&ds);
+    init_columns(&ds);
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, ",1,2,3", 6, 0));
 
     ASSERT_EQ_FMT(4, ds.columns, "%u");
@@ -214,16 +217,16 @@ DEF_TEST(input_leading_null) {
     point exp0_2 = { .x = 0, .y = 2 };
     point exp0_3 = { .x = 0, .y = 3 };
 
-    ASSERT_EQUAL_T(&exp0_0, &ds.pairs[0][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_1, &ds.pairs[1][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_2, &ds.pairs[2][0], type_point, NULL);
-    ASSERT_EQUAL_T(&exp0_3, &ds.pairs[3][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_1, &DS_POINT(&ds, 1, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_2, &DS_POINT(&ds, 2, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_3, &DS_POINT(&ds, 3, 0), type_point, NULL);
     
     PASS();
 }
 
 DEF_TEST(row_with_more_columns_pads_previous_with_nulls) {
-    init_pairs(&ds);
+    init_columns(&ds);
     // Pascal's Triangle
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "1", 1, 0));
     ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "1,1", 3, 1));
@@ -248,7 +251,7 @@ DEF_TEST(row_with_more_columns_pads_previous_with_nulls) {
 
     for (int r = 0; r < 3; r++) {
         for (int c = 0; c < 3; c++) {
-            ASSERT_EQUAL_T(&exp[c][r], &ds.pairs[c][r], type_point, NULL);
+            ASSERT_EQUAL_T(&exp[c][r], &DS_POINT(&ds, c, r), type_point, NULL);
         }
     }
 
@@ -256,7 +259,7 @@ DEF_TEST(row_with_more_columns_pads_previous_with_nulls) {
 }
 
 DEF_TEST(afl_crash0) {
-    init_pairs(&ds);
+    init_columns(&ds);
     char *lines[] = {
         "-3 -3 -2",
         "- -2",
@@ -303,7 +306,7 @@ DEF_TEST(afl_crash0) {
 
     for (int r = 0; r < ds.rows; r++) {
         for (int c = 0; c < ds.columns; c++) {
-            point *p = &ds.pairs[c][r];
+            point *p = &DS_POINT(&ds, c, r);
             if (GREATEST_IS_VERBOSE()) { printf("(%8g, %8g)\t", p->x, p->y); }
             ASSERT_EQUAL_T(&exp[c][r], p, type_point, NULL);
         }
@@ -314,7 +317,7 @@ DEF_TEST(afl_crash0) {
 }
 
 DEF_TEST(afl_crash1) {
-    init_pairs(&ds);
+    init_columns(&ds);
     char *lines[] = {
         "?",
     };
@@ -327,12 +330,12 @@ DEF_TEST(afl_crash1) {
     ASSERT_EQ(1, ds.rows);
 
     point exp = { .x = 0, .y = NAN };
-    ASSERT_EQUAL_T(&exp, &ds.pairs[0][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp, &DS_POINT(&ds, 0, 0), type_point, NULL);
     PASS();
 }
 
 DEF_TEST(afl_crash2) {
-    init_pairs(&ds);
+    init_columns(&ds);
     char *lines[] = {
         "-3E3333333333333333",
     };
@@ -345,7 +348,344 @@ DEF_TEST(afl_crash2) {
     ASSERT_EQ(1, ds.rows);
 
     point exp = { .x = 0, .y = EMPTY_VALUE };
-    ASSERT_EQUAL_T(&exp, &ds.pairs[0][0], type_point, NULL);
+    ASSERT_EQUAL_T(&exp, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(input_comment_to_eol) {
+    init_columns(&ds);
+    char line[] = "1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16#17,18";
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, line, strlen(line), 0));
+    ASSERT_EQ(16, ds.columns);
+
+    point exp = { .x = 0, .y = 16 };
+    ASSERT_EQUAL_T(&exp, &DS_POINT(&ds, 15, 0), type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(input_comment_marker_only_counts_at_cell_start) {
+    init_columns(&ds);
+    /* After a separator, the marker is read as a second separator,
+     * i.e. a missing value, and the rest of the line is still read. */
+    char line[] = "1 /2";
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, line, strlen(line), 0));
+    ASSERT_EQ(3, ds.columns);
+
+    point exp1 = { .x = 0, .y = NAN };
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(input_comment_to_eol_pads_columns) {
+    init_columns(&ds);
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "1,2,3", 5, 0));
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&empty_cfg, &ds, "4#5", 3, 1));
+
+    ASSERT_EQ(3, ds.columns);
+    ASSERT_EQ(2, ds.rows);
+    point exp1_1 = { .x = 1, .y = NAN };
+    point exp1_2 = { .x = 1, .y = NAN };
+    ASSERT_EQUAL_T(&exp1_1, &DS_POINT(&ds, 1, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_2, &DS_POINT(&ds, 2, 1), type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(input_columns_share_x) {
+    config cfg = { .x_column = true };
+    init_columns(&ds);
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "10 1 2", 6, 0));
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "20 3 4 5", 8, 1));
+
+    ASSERT_EQ(3, ds.columns);
+    point exp0_2 = { .x = 10, .y = NAN };
+    point exp1_2 = { .x = 20, .y = 5 };
+    ASSERT_EQUAL_T(&exp0_2, &DS_POINT(&ds, 2, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_2, &DS_POINT(&ds, 2, 1), type_point, NULL);
+    ASSERT_EQ(DS_XS(&ds, 0), DS_XS(&ds, 2));
+    PASS();
+}
+
+DEF_TEST(input_flip) {
+    config cfg = { .flip_xy = true };
+    init_columns(&ds);
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "23 24", 5, 0));
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "25 26", 5, 1));
+
+    point exp0_1 = { .x = 25, .y = 1 };
+    point exp1_1 = { .x = 26, .y = 1 };
+    ASSERT_EQUAL_T(&exp0_1, &DS_POINT(&ds, 0, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_1, &DS_POINT(&ds, 1, 1), type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(input_tracks_bounds_of_complete_points) {
+    config cfg = { .x_column = true };
+    init_columns(&ds);
+    ASSERT_FALSE(ds.has_bounds);
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, ",500", 4, 0));  // no X
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "-7,", 3, 1));   // no Y
+    ASSERT_FALSE(ds.has_bounds);
+
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "3,4,,-2", 7, 2));
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "10,,8", 5, 3));
+    ASSERT_EQ(SINK_LINE_OK, sink_line(&cfg, &ds, "1e9", 3, 4));
+    ASSERT(ds.has_bounds);
+    point exp_min = { .x = 3, .y = -2 };
+    point exp_max = { .x = 10, .y = 8 };
+    ASSERT_EQUAL_T(&exp_min, &ds.min, type_point, NULL);
+    ASSERT_EQUAL_T(&exp_max, &ds.max, type_point, NULL);
+
+    // reset for the next frame
+    init_columns(&ds);
+    ASSERT_FALSE(ds.has_bounds);
+    PASS();
+}
+
+static FILE *tmpfile_with(const char *contents) {
+    FILE *f = tmpfile();
+    if (f == NULL) { return NULL; }
+    fputs(contents, f);
+    rewind(f);
+    return f;
+}
+
+DEF_TEST(input_read_mapped_file) {
+    FILE *f = tmpfile_with("# header\n1 2\n3 4\n\n5 6\n");
+    ASSERT(f);
+    config cfg = { .in = f, .stream_mode = true };
+
+    ASSERT_EQ(0, input_read(&cfg, &ds));
+    ASSERT_EQ(2, ds.columns);
+    ASSERT_EQ(2, ds.rows);
+    point exp0_1 = { .x = 1, .y = 3 };
+    point exp1_1 = { .x = 1, .y = 4 };
+    ASSERT_EQUAL_T(&exp0_1, &DS_POINT(&ds, 0, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_1, &DS_POINT(&ds, 1, 1), type_point, NULL);
+    input_free(&ds);
+
+    // next frame, after the blank line
+    ASSERT_EQ(-1, input_read(&cfg, &ds));
+    ASSERT_EQ(1, ds.rows);
+    point exp1_0 = { .x = 0, .y = 6 };
+    ASSERT_EQUAL_T(&exp1_0, &DS_POINT(&ds, 1, 0), type_point, NULL);
+
+    input_close(&cfg);
+    fclose(f);
+    PASS();
+}
+
+DEF_TEST(input_read_mapped_file_without_trailing_newline) {
+    FILE *f = tmpfile_with("10\n20\n30");
+    ASSERT(f);
+    config cfg = { .in = f, .stream_mode = true };
+
+    ASSERT_EQ(-1, input_read(&cfg, &ds));
+    ASSERT_EQ(1, ds.columns);
+    ASSERT_EQ(3, ds.rows);
+    point exp2 = { .x = 2, .y = 30 };
+    ASSERT_EQUAL_T(&exp2, &DS_POINT(&ds, 0, 2), type_point, NULL);
+
+    input_close(&cfg);
+    fclose(f);
+    PASS();
+}
+
+/* A comment running to the end of the line ends that row, and its
+ * remaining columns are empty, as if the row were short. */
+DEF_TEST(input_comment_to_eol_after_separator) {
+    FILE *f = tmpfile_with("1 2\n3 # c\n");
+    ASSERT(f);
+    config cfg = { .in = f };
+
+    ASSERT_EQ(-1, input_read(&cfg, &ds));
+    ASSERT_EQ(2, ds.rows);
+    point exp0_0 = { .x = 0, .y = 1 };
+    point exp1_0 = { .x = 0, .y = 2 };
+    point exp0_1 = { .x = 1, .y = 3 };
+    point exp1_1 = { .x = 1, .y = NAN };
+    ASSERT_EQUAL_T(&exp0_0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_0, &DS_POINT(&ds, 1, 0), type_point, NULL);
+    ASSERT_EQUAL_T(&exp0_1, &DS_POINT(&ds, 0, 1), type_point, NULL);
+    ASSERT_EQUAL_T(&exp1_1, &DS_POINT(&ds, 1, 1), type_point, NULL);
+    for (uint8_t c = 2; c < ds.columns; c++) {
+        ASSERT(isnan(DS_YS(&ds, c)[0]));
+        ASSERT(isnan(DS_YS(&ds, c)[1]));
+    }
+
+    input_close(&cfg);
+    fclose(f);
+    PASS();
+}
+
+DEF_TEST(input_read_reuses_storage_across_frames) {
+    FILE *f = tmpfile_with("1 2 3\n4 5 6\n7 8 9\n\n10\n\n11 12\n");
+    ASSERT(f);
+    config cfg = { .in = f, .stream_mode = true };
+
+    ASSERT_EQ(0, input_read(&cfg, &ds));
+    ASSERT_EQ(3, ds.columns);
+    ASSERT_EQ(3, ds.rows);
+    double *xs = ds.xs;
+    double *ys1 = ds.ys[1];
+
+    // a smaller frame reuses the same storage
+    ASSERT_EQ(0, input_read(&cfg, &ds));
+    ASSERT_EQ(1, ds.columns);
+    ASSERT_EQ(1, ds.rows);
+    ASSERT_EQ(xs, ds.xs);
+    point exp0 = { .x = 0, .y = 10 };
+    ASSERT_EQUAL_T(&exp0, &DS_POINT(&ds, 0, 0), type_point, NULL);
+
+    // an allocated but unused column is reused without stale values
+    ASSERT_EQ(-1, input_read(&cfg, &ds));
+    ASSERT_EQ(2, ds.columns);
+    ASSERT_EQ(1, ds.rows);
+    ASSERT_EQ(ys1, ds.ys[1]);
+    point exp1 = { .x = 0, .y = 12 };
+    ASSERT_EQUAL_T(&exp1, &DS_POINT(&ds, 1, 0), type_point, NULL);
+
+    input_close(&cfg);
+    fclose(f);
+    PASS();
+}
+
+DEF_TEST(input_reader_preserves_frame_order) {
+    FILE *f = tmpfile();
+    ASSERT(f);
+    const size_t frames = 50;
+    for (size_t i = 0; i < frames; i++) {
+        if (i > 0) { fprintf(f, "\n"); }
+        for (size_t row = 0; row <= i % 7; row++) {
+            fprintf(f, "%zu %zu\n", 100 * i + row, i);
+        }
+    }
+    rewind(f);
+
+    config cfg = { .in = f, .stream_mode = true };
+    reader *r = reader_start(&cfg);
+    if (r == NULL) { SKIPm("couldn't start thread"); }
+
+    for (size_t i = 0; i < frames; i++) {
+        int res = 0;
+        data_set *rds = reader_next(r, &res);
+        ASSERT(rds);
+        ASSERT_EQ(i == frames - 1 ? -1 : 0, res);
+        ASSERT_EQ(2, rds->columns);
+        ASSERT_EQ(i % 7 + 1, rds->rows);
+        for (size_t row = 0; row < rds->rows; row++) {
+            point exp0 = { .x = row, .y = 100 * i + row };
+            point exp1 = { .x = row, .y = i };
+            ASSERT_EQUAL_T(&exp0, &DS_POINT(rds, 0, row), type_point, NULL);
+            ASSERT_EQUAL_T(&exp1, &DS_POINT(rds, 1, row), type_point, NULL);
+        }
+    }
+
+    reader_stop(r);
+    input_close(&cfg);
+    fclose(f);
+    PASS();
+}
+
+/* Write a frame of about BYTES, with a comment, and a row with extra
+ * columns part-way through. */
+static void write_frame(FILE *f, size_t bytes, unsigned seed) {
+    size_t written = 0;
+    for (unsigned i = 0; written < bytes; i++) {
+        if (i == 1000) {
+            written += fprintf(f, "# a comment\n");
+        } else if (i == 50000) {
+            written += fprintf(f, "%u,%u,%u,%u,,%u\n", i, seed, i % 7, i, i);
+        } else if (i % 11 == 0) {
+            written += fprintf(f, "%u,,%g\n", i, (i * seed) / 100.0);
+        } else {
+            written += fprintf(f, "%u,%u,%g\n", i, (i * seed) % 977, i * 0.25);
+        }
+    }
+}
+
+/* The bounds found while parsing match a separate scan of the points. */
+static greatest_test_res bounds_match_scan(data_set *ds) {
+    data_set unflipped = *ds;
+    unflipped.flip_xy = false;
+    point min, max;
+    ASSERT(ds->has_bounds);
+    ASSERT(bounds_scan(&unflipped, &min, &max));
+    ASSERT_EQUAL_T(&min, &ds->min, type_point, NULL);
+    ASSERT_EQUAL_T(&max, &ds->max, type_point, NULL);
+    PASS();
+}
+
+static greatest_test_res same_data_set(data_set *exp, data_set *got) {
+    ASSERT_EQ_FMT(exp->rows, got->rows, "%zu");
+    ASSERT_EQ_FMT(exp->columns, got->columns, "%u");
+    CHECK_CALL(bounds_match_scan(exp));
+    CHECK_CALL(bounds_match_scan(got));
+    for (uint8_t c = 0; c < exp->columns; c++) {
+        for (size_t r = 0; r < exp->rows; r++) {
+            point *pe = &DS_POINT(exp, c, r);
+            point *pg = &DS_POINT(got, c, r);
+            if (IS_EMPTY_POINT(pe)) {
+                ASSERT(IS_EMPTY_POINT(pg));
+            } else {
+                ASSERT_EQUAL_T(pe, pg, type_point, NULL);
+            }
+        }
+    }
+    PASS();
+}
+
+static greatest_test_res parallel_matches_serial(config *cfg) {
+    FILE *f = tmpfile();
+    ASSERT(f);
+    write_frame(f, 6 * 1024 * 1024, 3);
+    fprintf(f, "\n");
+    write_frame(f, 5 * 1024 * 1024, 5);
+
+    data_set serial[2];
+    data_set parallel[2];
+    memset(serial, 0, sizeof(serial));
+    memset(parallel, 0, sizeof(parallel));
+
+    rewind(f);
+    parallel_set_threads(1);
+    cfg->in = f;
+    ASSERT_EQ(0, input_read(cfg, &serial[0]));
+    ASSERT_EQ(-1, input_read(cfg, &serial[1]));
+    input_close(cfg);
+
+    rewind(f);
+    parallel_set_threads(4);
+    ASSERT_EQ(0, input_read(cfg, &parallel[0]));
+    ASSERT_EQ(-1, input_read(cfg, &parallel[1]));
+    input_close(cfg);
+    parallel_set_threads(0);
+
+    CHECK_CALL(same_data_set(&serial[0], &parallel[0]));
+    CHECK_CALL(same_data_set(&serial[1], &parallel[1]));
+
+    for (int i = 0; i < 2; i++) {
+        input_free(&serial[i]);
+        input_free(&parallel[i]);
+    }
+    fclose(f);
+    PASS();
+}
+
+DEF_TEST(input_read_parallel_matches_serial) {
+    config cfg = { .stream_mode = true };
+    CHECK_CALL(parallel_matches_serial(&cfg));
+    PASS();
+}
+
+DEF_TEST(input_read_parallel_matches_serial_x_column) {
+    config cfg = { .stream_mode = true, .x_column = true };
+    CHECK_CALL(parallel_matches_serial(&cfg));
+    PASS();
+}
+
+DEF_TEST(input_read_parallel_matches_serial_flipped) {
+    config cfg = { .stream_mode = true, .flip_xy = true };
+    CHECK_CALL(parallel_matches_serial(&cfg));
     PASS();
 }
 
@@ -362,6 +702,12 @@ SUITE(s_input) {
     RUN_TEST(input_tab);
     RUN_TEST(input_exponent);
     RUN_TEST(input_multiline);
+    RUN_TEST(input_comment_to_eol);
+    RUN_TEST(input_comment_marker_only_counts_at_cell_start);
+    RUN_TEST(input_comment_to_eol_pads_columns);
+    RUN_TEST(input_columns_share_x);
+    RUN_TEST(input_flip);
+    RUN_TEST(input_tracks_bounds_of_complete_points);
 
     // empty cell handling
     RUN_TEST(input_single_column_null);
@@ -370,6 +716,16 @@ SUITE(s_input) {
     RUN_TEST(input_leading_null);
     RUN_TEST(row_with_more_columns_pads_previous_with_nulls);
 
+    // reading from a (memory-mapped) file
+    RUN_TEST(input_read_mapped_file);
+    RUN_TEST(input_read_mapped_file_without_trailing_newline);
+    RUN_TEST(input_comment_to_eol_after_separator);
+    RUN_TEST(input_read_reuses_storage_across_frames);
+    RUN_TEST(input_reader_preserves_frame_order);
+    RUN_TEST(input_read_parallel_matches_serial);
+    RUN_TEST(input_read_parallel_matches_serial_x_column);
+    RUN_TEST(input_read_parallel_matches_serial_flipped);
+
     // fuzzer cases
     RUN_TEST(afl_crash0);
     RUN_TEST(afl_crash1);
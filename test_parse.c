@@ -0,0 +1,112 @@
+#include "test_guff.h"
+
+#include "parse.h"
+
+static void setup_cb(void *data) {
+}
+
+static void teardown_cb(void *data) {
+}
+
+/* Check that parse_double matches strtod(3) bit-for-bit, and that
+ * it stops at the same place. */
+static greatest_test_res matches_strtod(const char *s) {
+    char *exp_end = NULL;
+    double exp = strtod(s, &exp_end);
+
+    const char *got_end = NULL;
+    double got = parse_double(s, s + strlen(s), &got_end);
+
+    ASSERT_EQ_FMTm(s, (size_t)(exp_end - s), (size_t)(got_end - s), "%zu");
+    ASSERTm(s, 0 == memcmp(&exp, &got, sizeof(exp)));
+    PASS();
+}
+
+DEF_TEST(parse_matches_strtod_for_examples) {
+    const char *examples[] = {
+        "0", "-0", "+0", "1", "23", "-23", "99.9", "999.999",
+        "-24e-7", "+50e5", ".5", "-.5", "5.", "00012", "0.000123",
+        "1e", "1e+", "1e-", "1e-5x", "1E5", "1.5e22", "1.5e23",
+        "3.14159265358979", "2.718281828459045", "0.1", "0.3",
+        "9007199254740992", "9007199254740993", "12345678901234567",
+        "123456789012345678901234", "0.000000000000000000000001",
+        "4.9e-324", "2.2250738585072014e-308", "1.7976931348623157e308",
+        "1e400", "-1e400", "1e-400", "-3E3333333333333333", "0e99999",
+        "0x1p3", "0X10", "0x", "inf", "-Infinity", "nan", "-nan(123)",
+        "-", "+", ".", "-.", ".e5", "e5", "1,2", "1 2", "1-2", "1e5e3",
+        "1.2.3", "7\n", "123456789.123456789",
+    };
+
+    for (size_t i = 0; i < sizeof(examples)/sizeof(examples[0]); i++) {
+        CHECK_CALL(matches_strtod(examples[i]));
+    }
+    PASS();
+}
+
+DEF_TEST(parse_matches_strtod_for_random_numbers) {
+    uint64_t state = 23;
+    char buf[64];
+
+    for (size_t i = 0; i < 100000; i++) {
+        size_t o = 0;
+        if (prng(&state) % 4 == 0) { buf[o++] = '-'; }
+
+        size_t digits = 1 + prng(&state) % 22;
+        size_t dot = prng(&state) % (digits + 2);
+        for (size_t d = 0; d < digits; d++) {
+            if (d == dot) { buf[o++] = '.'; }
+            buf[o++] = '0' + prng(&state) % 10;
+        }
+
+        if (prng(&state) % 3 == 0) {
+            int e = (int)(prng(&state) % 80) - 40;
+            o += snprintf(&buf[o], sizeof(buf) - o, "e%d", e);
+        }
+        buf[o] = '\0';
+
+        CHECK_CALL(matches_strtod(buf));
+    }
+    PASS();
+}
+
+DEF_TEST(parse_stops_at_end) {
+    const char *s = "12345";
+    const char *out = NULL;
+
+    double v = parse_double(s, s + 3, &out);
+    ASSERT_EQ_FMT(123.0, v, "%g");
+    ASSERT_EQ(s + 3, out);
+
+    const char *e = "1e5";
+    v = parse_double(e, e + 2, &out);
+    ASSERT_EQ_FMT(1.0, v, "%g");
+    ASSERT_EQ(e + 1, out);
+
+    const char *hex = "0x10";
+    v = parse_double(hex, hex + 3, &out);
+    ASSERT_EQ_FMT(1.0, v, "%g");
+    ASSERT_EQ(hex + 3, out);
+    PASS();
+}
+
+DEF_TEST(parse_no_number) {
+    const char *s = "-,";
+    const char *out = NULL;
+    double v = parse_double(s, s + 2, &out);
+    ASSERT_EQ_FMT(0.0, v, "%g");
+    ASSERT_EQ(s, out);
+
+    v = parse_double(s, s, &out);
+    ASSERT_EQ(s, out);
+    PASS();
+}
+
+SUITE(s_parse) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(parse_matches_strtod_for_examples);
+    RUN_TEST(parse_matches_strtod_for_random_numbers);
+    RUN_TEST(parse_stops_at_end);
+    RUN_TEST(parse_no_number);
+}
@@ -0,0 +1,187 @@
+#include "test_guff.h"
+
+#include "draw.h"
+#include "input.h"
+#include "input_internal.h"
+#include "raster.h"
+
+static void setup_cb(void *data) {
+}
+
+static void teardown_cb(void *data) {
+}
+
+#define OUT_SIZE (64 * 1024)
+
+struct frame {
+    config *cfg;
+    char **lines;
+    size_t count;
+    size_t batch;               /* lines per raster_add */
+};
+
+static int draw_frame(void *udata) {
+    struct frame *f = udata;
+    data_set ds = { .ys = NULL };
+    init_columns(&ds);
+    for (size_t i = 0; i < f->count; i++) {
+        sink_line(f->cfg, &ds, f->lines[i], strlen(f->lines[i]), i);
+    }
+    int res = draw(f->cfg, &ds);
+    draw_close(f->cfg);
+    input_free(&ds);
+    return res;
+}
+
+/* Add the frame's lines in batches, numbering each batch's rows from
+ * 0, as input_read does. */
+static int raster_frame(void *udata) {
+    struct frame *f = udata;
+    raster *r = raster_new(f->cfg);
+    data_set ds = { .ys = NULL };
+    for (size_t i = 0; i < f->count; i += f->batch) {
+        init_columns(&ds);
+        for (size_t j = i; j < i + f->batch && j < f->count; j++) {
+            sink_line(f->cfg, &ds, f->lines[j], strlen(f->lines[j]), j - i);
+        }
+        raster_add(r, &ds);
+    }
+    int res = raster_draw(r);
+    raster_free(r);
+    input_free(&ds);
+    return res;
+}
+
+static char *lines[] = {
+    "3 5",
+    "-2 7 1",
+    "8 12",
+    "9  4",
+    "1 2 3",
+    "4 5 6",
+    "30 30",                    // outside the pinned bounds
+    "5 1.5 2.5",
+    "6 0.5 10",
+};
+
+static greatest_test_res raster_matches_draw(config *cfg) {
+    if (!cfg->pin_x.pinned) {
+        cfg->pin_x = (axis_pin){ .pinned = true, .min = 0, .max = 10 };
+    }
+    cfg->pin_y = (axis_pin){ .pinned = true, .min = -1, .max = 10 };
+    cfg->width = 30;
+    cfg->height = 15;
+    cfg->axis = true;
+    ASSERT(raster_supported(cfg));
+
+    struct frame f = {
+        .cfg = cfg,
+        .lines = lines,
+        .count = sizeof(lines)/sizeof(lines[0]),
+    };
+    static char expected[OUT_SIZE], got[OUT_SIZE];
+    ASSERT_EQ(0, capture_stdout(draw_frame, &f, expected, OUT_SIZE));
+
+    for (f.batch = 1; f.batch <= f.count; f.batch++) {
+        ASSERT_EQ(0, capture_stdout(raster_frame, &f, got, OUT_SIZE));
+        ASSERT_STR_EQ(expected, got);
+    }
+    PASS();
+}
+
+DEF_TEST(raster_matches_draw_dots) {
+    config cfg = { .x_column = true };
+    CHECK_CALL(raster_matches_draw(&cfg));
+    PASS();
+}
+
+DEF_TEST(raster_matches_draw_counts) {
+    config cfg = { .mode = MODE_COUNT };
+    CHECK_CALL(raster_matches_draw(&cfg));
+    PASS();
+}
+
+DEF_TEST(raster_matches_draw_heat) {
+    // ASCII heat maps are drawn like count mode
+    config cfg = { .mode = MODE_HEAT, .heat_bin = 4 };
+    CHECK_CALL(raster_matches_draw(&cfg));
+    PASS();
+}
+
+DEF_TEST(raster_matches_draw_hex) {
+    config cfg = { .mode = MODE_HEX, .heat_bin = 4 };
+    CHECK_CALL(raster_matches_draw(&cfg));
+    PASS();
+}
+
+DEF_TEST(raster_matches_draw_flipped_log) {
+    config cfg = {
+        .flip_xy = true,
+        .log_x = true,
+        .x_column = true,
+        .pin_x = { .pinned = true, .min = 0.25, .max = 20 },
+    };
+    CHECK_CALL(raster_matches_draw(&cfg));
+    PASS();
+}
+
+/* ASCII draws line mode as points, so with pinned bounds, points
+ * outside them must be clipped just as in dot mode. */
+DEF_TEST(ascii_lines_pinned_draw_like_dots) {
+    static char dots[OUT_SIZE], got[OUT_SIZE];
+    config cfg = {
+        .x_column = true,
+        .pin_x = { .pinned = true, .min = 0, .max = 10 },
+        .pin_y = { .pinned = true, .min = -1, .max = 10 },
+        .width = 30,
+        .height = 15,
+        .axis = true,
+    };
+    struct frame f = {
+        .cfg = &cfg,
+        .lines = lines,
+        .count = sizeof(lines)/sizeof(lines[0]),
+    };
+    ASSERT_EQ(0, capture_stdout(draw_frame, &f, dots, OUT_SIZE));
+    cfg.mode = MODE_LINE;
+    ASSERT_EQ(0, capture_stdout(draw_frame, &f, got, OUT_SIZE));
+    ASSERT_STR_EQ(dots, got);
+
+    // only Y pinned, with a point far above it
+    char *above[] = { "1", "2", "3", "50" };
+    cfg = (config){
+        .mode = MODE_LINE,
+        .pin_y = { .pinned = true, .min = 0, .max = 5 },
+        .width = 30,
+        .height = 15,
+    };
+    f = (struct frame){ .cfg = &cfg, .lines = above, .count = 4 };
+    ASSERT_EQ(0, capture_stdout(draw_frame, &f, got, OUT_SIZE));
+    cfg.mode = MODE_DOT;
+    ASSERT_EQ(0, capture_stdout(draw_frame, &f, dots, OUT_SIZE));
+    ASSERT_STR_EQ(dots, got);
+    PASS();
+}
+
+DEF_TEST(raster_needs_both_axes_pinned) {
+    config cfg = { .pin_x = { .pinned = true, .min = 0, .max = 1 } };
+    ASSERT_FALSE(raster_supported(&cfg));
+    cfg.pin_y = cfg.pin_x;
+    ASSERT(raster_supported(&cfg));
+    cfg.mode = MODE_LINE;
+    ASSERT_FALSE(raster_supported(&cfg));
+    PASS();
+}
+
+SUITE(s_raster) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(raster_matches_draw_dots);
+    RUN_TEST(raster_matches_draw_counts);
+    RUN_TEST(raster_matches_draw_heat);
+    RUN_TEST(raster_matches_draw_hex);
+    RUN_TEST(raster_matches_draw_flipped_log);
+    RUN_TEST(ascii_lines_pinned_draw_like_dots);
+    RUN_TEST(raster_needs_both_axes_pinned);
+}
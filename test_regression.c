@@ -9,10 +9,25 @@ static void setup_cb(void *data) {
 static void teardown_cb(void *data) {
 }
 
+#define MAX_POINTS 16
+
+/* Split points into X and Y columns and run the regression. */
+static void regress_points(point *points, size_t count, transform_t t,
+        double *slope, double *intercept) {
+    double xs[MAX_POINTS];
+    double ys[MAX_POINTS];
+    assert(count <= MAX_POINTS);
+    for (size_t i = 0; i < count; i++) {
+        xs[i] = points[i].x;
+        ys[i] = points[i].y;
+    }
+    regression(xs, ys, count, t, slope, intercept);
+}
+
 DEF_TEST(input_empty) {
     double slope = 0;
     double intercept = 0;
-    regression(NULL, 0, TRANSFORM_NONE, &slope, &intercept);
+    regression(NULL, NULL, 0, TRANSFORM_NONE, &slope, &intercept);
 
     ASSERT(IS_EMPTY(slope));
     ASSERT(IS_EMPTY(intercept));
@@ -31,7 +46,7 @@ DEF_TEST(input_simple) {
         {.x = 3, .y = 25},
         {.x = 4, .y = 30},
     };
-    regression(points, 5, TRANSFORM_NONE, &slope, &intercept);
+    regress_points(points, 5, TRANSFORM_NONE, &slope, &intercept);
 
     ASSERT_IN_RANGE(5, slope, 0.001);
     ASSERT_IN_RANGE(10, intercept, 0.001);
@@ -50,7 +65,7 @@ DEF_TEST(input_off_axis) {
         {.x = 1030, .y = 1035},
         {.x = 1040, .y = 1080},
     };
-    regression(points, 5, TRANSFORM_NONE, &slope, &intercept);
+    regress_points(points, 5, TRANSFORM_NONE, &slope, &intercept);
 
     ASSERT_IN_RANGE(1.85, slope, 0.001);
     ASSERT_IN_RANGE(-858, intercept, 0.001);
@@ -69,7 +84,7 @@ DEF_TEST(input_xy) {
         {.x = 3, .y = 3},
         {.x = 9, .y = 9},
     };
-    regression(points, 5, TRANSFORM_NONE, &slope, &intercept);
+    regress_points(points, 5, TRANSFORM_NONE, &slope, &intercept);
 
     ASSERT_IN_RANGE(0.901, slope, 0.001);
     ASSERT_IN_RANGE(0.738197, intercept, 0.001);
@@ -88,7 +103,7 @@ DEF_TEST(input_log_x) {
         {.x = exp(3), .y = 3 + 50 },
         {.x = exp(4), .y = 4 + 50 },
     };
-    regression(points, 5, TRANSFORM_LOG_X, &slope, &intercept);
+    regress_points(points, 5, TRANSFORM_LOG_X, &slope, &intercept);
 
     ASSERT(!isnan(slope));
     ASSERT(!isnan(intercept));
@@ -109,7 +124,7 @@ DEF_TEST(input_log_y_no_intercept) {
         {.x = 3, .y = exp(3)},
         {.x = 4, .y = exp(4)},
     };
-    regression(points, 5, TRANSFORM_LOG_Y, &slope, &intercept);
+    regress_points(points, 5, TRANSFORM_LOG_Y, &slope, &intercept);
 
     ASSERT(!isnan(slope));
     ASSERT(!isnan(intercept));
@@ -130,7 +145,7 @@ DEF_TEST(input_log_y_intercept) {
         {.x = 3, .y = exp(3) + 10 },
         {.x = 4, .y = exp(4) + 10 },
     };
-    regression(points, 5, TRANSFORM_LOG_Y, &slope, &intercept);
+    regress_points(points, 5, TRANSFORM_LOG_Y, &slope, &intercept);
 
     ASSERT(!isnan(slope));
     ASSERT(!isnan(intercept));
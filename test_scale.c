@@ -11,6 +11,7 @@ static void setup_cb(void *data) {
 }
 
 static void teardown_cb(void *data) {
+    scale_set_exact_log(false);
     /* free_rows(&pi); */
     /* input_free(&ds); */
 }
@@ -115,7 +116,7 @@ DEF_TEST(scale_example_regression) {
     PASS();
 }
 
-DEF_TEST(scale_points) {
+DEF_TEST(scale_several_points) {
     plot_info pi = {
         .min_x = -100,
         .max_x = 100,
@@ -229,6 +230,215 @@ DEF_TEST(scale_out_of_range) {
     PASS();
 }
 
+DEF_TEST(scale_points_clips_to_pinned_bounds) {
+    plot_info pi = {
+        .min_x = 10,
+        .max_x = 20,
+        .min_y = 0,
+        .max_y = 100,
+        .clip = true,
+
+        .w = 72,
+        .h = 40,
+    };
+    transform_t t = init_pi(&pi);
+    double xs[] = { 10, 20, 9.999, 20.001, 15, 15, 15 };
+    double ys[] = { 0, 100, 50, 50, -0.001, 100.001, 50 };
+    enum { COUNT = sizeof(xs)/sizeof(xs[0]) };
+    scaled_point out[COUNT];
+
+    scale_points(&pi, xs, ys, COUNT, t, out);
+
+    for (size_t i = 0; i < COUNT; i++) {
+        bool inside = (i < 2 || i == COUNT - 1);
+        if (inside) {
+            ASSERT(out[i].x >= 0 && out[i].x < (int32_t)pi.w);
+            ASSERT(out[i].y >= 0 && out[i].y < (int32_t)pi.h);
+        } else {
+            ASSERT_EQ_FMT(SCALED_EMPTY, out[i].x, "%d");
+            ASSERT_EQ_FMT(SCALED_EMPTY, out[i].y, "%d");
+        }
+    }
+    PASS();
+}
+
+static greatest_test_res batch_matches_single(bool log_x, bool log_y) {
+    plot_info pi = {
+        .min_x = log_x ? log(0.5) : -50,
+        .max_x = log_x ? log(2000) : 2000,
+        .min_y = log_y ? log(0.5) : -50,
+        .max_y = log_y ? log(2000) : 2000,
+        .log_x = log_x,
+        .log_y = log_y,
+        .w = 640,
+        .h = 480,
+    };
+    transform_t t = init_pi(&pi);
+
+    enum { COUNT = 3000 };
+    static double xs[COUNT], ys[COUNT];
+    static scaled_point out[COUNT];
+    uint64_t state = 11;
+    for (size_t i = 0; i < COUNT; i++) {
+        double lo = (log_x || log_y) ? 0.5 : -50;
+        xs[i] = lo + (prng(&state) % 1000000) / 1000000.0 * (2000 - lo);
+        ys[i] = lo + (prng(&state) % 1000000) / 1000000.0 * (2000 - lo);
+        if (i % 17 == 0) { xs[i] = EMPTY_VALUE; }
+        if (i % 23 == 0) { ys[i] = EMPTY_VALUE; }
+    }
+
+    scale_points(&pi, xs, ys, COUNT, t, out);
+
+    for (size_t i = 0; i < COUNT; i++) {
+        if (IS_EMPTY(xs[i]) || IS_EMPTY(ys[i])) {
+            ASSERT_EQ_FMT(SCALED_EMPTY, out[i].x, "%d");
+            ASSERT_EQ_FMT(SCALED_EMPTY, out[i].y, "%d");
+            continue;
+        }
+        point p = { .x = xs[i], .y = ys[i] };
+        scaled_point sp;
+        scale_point(&pi, &p, &sp, t);
+        ASSERT_EQ_FMT(sp.x, out[i].x, "%d");
+        ASSERT_EQ_FMT(sp.y, out[i].y, "%d");
+    }
+    PASS();
+}
+
+DEF_TEST(scale_batch_matches_single) {
+    CHECK_CALL(batch_matches_single(false, false));
+    CHECK_CALL(batch_matches_single(true, false));
+    CHECK_CALL(batch_matches_single(false, true));
+    CHECK_CALL(batch_matches_single(true, true));
+    PASS();
+}
+
+DEF_TEST(scale_transform_data_set_logs_each_axis_once) {
+    double xs[] = { 1, 10, 100 };
+    double y0[] = { 2, EMPTY_VALUE, 20 };
+    double y1[] = { 3, 30, 300 };
+    double *ys[] = { y0, y1 };
+    data_set raw = { .columns = 2, .rows = 3, .xs = xs, .ys = ys };
+    struct transform_cache *cache = NULL;
+    data_set out;
+
+    // -l y: the shared X column is untouched
+    scale_transform_data_set(&cache, &raw, TRANSFORM_LOG_Y, &out);
+    ASSERT_EQ(xs, out.xs);
+    ASSERT_IN_RANGE(log(2), out.ys[0][0], 1e-9);
+    ASSERT(IS_EMPTY(out.ys[0][1]));
+    ASSERT_IN_RANGE(log(30), out.ys[1][1], 1e-9);
+
+    // -l x, flipped: X is now each column's values, so only they change
+    raw.flip_xy = true;
+    scale_transform_data_set(&cache, &raw, TRANSFORM_LOG_X, &out);
+    ASSERT_EQ(xs, out.xs);
+    ASSERT_IN_RANGE(log(300), out.ys[1][2], 1e-9);
+    ASSERT_IN_RANGE(log(20), DS_XS(&out, 0)[2], 1e-9);
+    ASSERT_EQ_FMT(100.0, DS_YS(&out, 0)[2], "%g");
+
+    scale_free_transform_cache(cache);
+    PASS();
+}
+
+/* A value's position on a log-scaled axis, in pixels (unclamped). */
+static double log_pixel(double v, double lo, double hi, double w,
+        double (*logf)(double)) {
+    return (logf(v) - log(lo)) * w / (log(hi) - log(lo));
+}
+
+DEF_TEST(scale_fast_log_error_is_far_under_a_pixel) {
+    /* Axis ranges from very narrow to the whole range of doubles, on
+     * a plot far wider than any realistic SVG. */
+    const double w = 65536;
+    const double ranges[][2] = {
+        { 1, 1.001 }, { 0.5, 2000 }, { 1e-6, 1e6 }, { 999, 1001 },
+        { 1e-300, 1e300 }, { 4.9e-324, 1.7976931348623157e308 },
+    };
+    uint64_t state = 5;
+    double max_err = 0;
+
+    for (size_t r = 0; r < sizeof(ranges)/sizeof(ranges[0]); r++) {
+        double lo = ranges[r][0];
+        double hi = ranges[r][1];
+        double llo = log(lo), lhi = log(hi);
+        for (size_t i = 0; i < 100000; i++) {
+            // uniform on the log axis, so every exponent gets sampled
+            double u = prng(&state) / (double)UINT32_MAX;
+            double v = exp(llo + u * (lhi - llo));
+            if (v < lo) { v = lo; }
+            if (v > hi || isinf(v)) { v = hi; }
+            double err = fabs(log_pixel(v, lo, hi, w, scale_log)
+                - log_pixel(v, lo, hi, w, log));
+            if (err > max_err) { max_err = err; }
+        }
+    }
+    ASSERTm("fast log error should be < 0.001 pixel", max_err < 1e-3);
+    PASS();
+}
+
+DEF_TEST(scale_fast_log_special_values) {
+    ASSERT_EQ_FMT(0.0, scale_log(1), "%g");
+    ASSERT(isinf(scale_log(0)) && scale_log(0) < 0);
+    ASSERT(isinf(scale_log(-0.0)) && scale_log(-0.0) < 0);
+    ASSERT(isnan(scale_log(-1)));
+    ASSERT(isnan(scale_log(-INFINITY)));
+    ASSERT(isnan(scale_log(NAN)));
+    ASSERT(isinf(scale_log(INFINITY)) && scale_log(INFINITY) > 0);
+
+    // subnormals, and either side of each power of 2
+    ASSERT_IN_RANGE(log(4.9e-324), scale_log(4.9e-324), 1e-9);
+    ASSERT_IN_RANGE(log(1e-310), scale_log(1e-310), 1e-9);
+    for (int e = -1022; e <= 1023; e++) {
+        double p = ldexp(1, e);
+        ASSERT_IN_RANGE(log(p), scale_log(p), 1e-9);
+        ASSERT_IN_RANGE(log(nextafter(p, 0)), scale_log(nextafter(p, 0)), 1e-9);
+        ASSERT_IN_RANGE(log(p * 1.4142135623730951), scale_log(p * 1.4142135623730951), 1e-9);
+    }
+    PASS();
+}
+
+/* The vectorized loops over columns get the same results as scale_log,
+ * including at the end of each column, past the last full vector. */
+DEF_TEST(scale_transform_data_set_matches_scale_log) {
+    enum { ROWS = 1027 };
+    static double xs[ROWS], y0[ROWS];
+    double *ys[] = { y0 };
+    uint64_t state = 9;
+    for (size_t i = 0; i < ROWS; i++) {
+        xs[i] = i;
+        y0[i] = ldexp(1 + prng(&state) / (double)UINT32_MAX,
+            (int)(prng(&state) % 2000) - 1000);
+    }
+    y0[0] = EMPTY_VALUE;        // so X = 0 isn't plotted, and maps to 0
+    y0[3] = 4.9e-324;
+    data_set raw = { .columns = 1, .rows = ROWS, .xs = xs, .ys = ys };
+    struct transform_cache *cache = NULL;
+    data_set out;
+
+    scale_transform_data_set(&cache, &raw, TRANSFORM_LOG_XY, &out);
+    ASSERT_EQ_FMT(0.0, out.xs[0], "%g");
+    ASSERT(IS_EMPTY(out.ys[0][0]));
+    for (size_t i = 1; i < ROWS; i++) {
+        ASSERT_EQ_FMT(scale_log(xs[i]), out.xs[i], "%.17g");
+        ASSERT_EQ_FMT(scale_log(y0[i]), out.ys[0][i], "%.17g");
+    }
+
+    scale_free_transform_cache(cache);
+    PASS();
+}
+
+DEF_TEST(scale_exact_log_uses_libm) {
+    scale_set_exact_log(true);
+    uint64_t state = 7;
+    for (size_t i = 0; i < 10000; i++) {
+        double v = prng(&state) / 1000.0 + 1e-3;
+        double exp = log(v);
+        double got = scale_log(v);
+        ASSERT(0 == memcmp(&exp, &got, sizeof(exp)));
+    }
+    PASS();
+}
+
 SUITE(s_scale) {
     SET_SETUP(setup_cb, NULL);
     SET_TEARDOWN(teardown_cb, NULL);
@@ -239,9 +449,16 @@ SUITE(s_scale) {
     RUN_TEST(scale_basic);
     RUN_TEST(scale_centered_origin);
     RUN_TEST(scale_example_regression);
-    RUN_TEST(scale_points);
+    RUN_TEST(scale_several_points);
     RUN_TEST(scale_basic_log);
     RUN_TEST(scale_points_log);
 
     RUN_TEST(scale_out_of_range);
+    RUN_TEST(scale_points_clips_to_pinned_bounds);
+    RUN_TEST(scale_batch_matches_single);
+    RUN_TEST(scale_transform_data_set_logs_each_axis_once);
+    RUN_TEST(scale_fast_log_error_is_far_under_a_pixel);
+    RUN_TEST(scale_fast_log_special_values);
+    RUN_TEST(scale_transform_data_set_matches_scale_log);
+    RUN_TEST(scale_exact_log_uses_libm);
 }
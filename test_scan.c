@@ -0,0 +1,84 @@
+#include "test_guff.h"
+
+#include "scan.h"
+
+static void setup_cb(void *data) {
+}
+
+static void teardown_cb(void *data) {
+    /* restore the widest implementation */
+    if (!scan_set_impl(SCAN_IMPL_AVX2)) {
+        if (!scan_set_impl(SCAN_IMPL_SSE2)) {
+            scan_set_impl(SCAN_IMPL_SCALAR);
+        }
+    }
+}
+
+static const char *ref_find(const char *p, const char *end,
+        const char *set, size_t set_size) {
+    for (; p < end; p++) {
+        if (memchr(set, *p, set_size)) { return p; }
+    }
+    return end;
+}
+
+#define BUF_SIZE 200
+
+/* Compare an implementation against a byte-at-a-time reference, for
+ * every start offset and length, so the vector/tail boundaries
+ * all get exercised. */
+static greatest_test_res matches_reference(scan_impl_t impl) {
+    if (!scan_set_impl(impl)) { SKIPm("unsupported on this CPU"); }
+
+    char buf[BUF_SIZE];
+    uint64_t state = 42;
+    const char noise[] = "0123456789 ,.-e\t";
+
+    for (int round = 0; round < 20; round++) {
+        for (size_t i = 0; i < BUF_SIZE; i++) {
+            uint32_t r = prng(&state) % 64;
+            switch (r) {
+            case 0: buf[i] = '\n'; break;
+            case 1: buf[i] = '#'; break;
+            case 2: buf[i] = '/'; break;
+            case 3: buf[i] = '\0'; break;
+            default: buf[i] = noise[r % (sizeof(noise) - 1)]; break;
+            }
+        }
+
+        for (size_t start = 0; start < 40; start++) {
+            for (size_t end = start; end <= BUF_SIZE; end++) {
+                const char *p = &buf[start];
+                const char *e = &buf[end];
+                ASSERT_EQ(ref_find(p, e, "\n", 1), scan_newline(p, e));
+                // the set includes the string's '\0'
+                ASSERT_EQ(ref_find(p, e, "#/", 3), scan_comment(p, e));
+            }
+        }
+    }
+    PASS();
+}
+
+DEF_TEST(scan_scalar) {
+    CHECK_CALL(matches_reference(SCAN_IMPL_SCALAR));
+    PASS();
+}
+
+DEF_TEST(scan_sse2) {
+    CHECK_CALL(matches_reference(SCAN_IMPL_SSE2));
+    PASS();
+}
+
+DEF_TEST(scan_avx2) {
+    CHECK_CALL(matches_reference(SCAN_IMPL_AVX2));
+    PASS();
+}
+
+SUITE(s_scan) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(scan_scalar);
+    RUN_TEST(scan_sse2);
+    RUN_TEST(scan_avx2);
+}
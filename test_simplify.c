@@ -0,0 +1,111 @@
+#include "test_guff.h"
+
+#include "simplify.h"
+
+static void setup_cb(void *data) {
+}
+
+static void teardown_cb(void *data) {
+}
+
+static double tri_area(scaled_point a, scaled_point b, scaled_point c) {
+    double cross = ((double)b.x - a.x) * ((double)c.y - a.y)
+        - ((double)c.x - a.x) * ((double)b.y - a.y);
+    return fabs(cross) / 2;
+}
+
+/* Visvalingam-Whyatt, the slow and obvious way: rescan for the
+ * smallest area after every removal. */
+static size_t ref_simplify(scaled_point *ps, size_t count, double min_area) {
+    if (count <= 2) { return count; }
+    double *area = calloc(count, sizeof(*area));
+    for (size_t i = 1; i < count - 1; i++) {
+        area[i] = tri_area(ps[i - 1], ps[i], ps[i + 1]);
+    }
+    for (;;) {
+        size_t min = 0;
+        for (size_t i = 1; i < count - 1; i++) {
+            if (min == 0 || area[i] < area[min]) { min = i; }
+        }
+        if (min == 0 || !(area[min] < min_area)) { break; }
+        double removed = area[min];
+        memmove(&ps[min], &ps[min + 1], (count - min - 1) * sizeof(*ps));
+        memmove(&area[min], &area[min + 1], (count - min - 1) * sizeof(*area));
+        count--;
+        for (size_t i = min - 1; i <= min; i++) {
+            if (i == 0 || i == count - 1) { continue; }
+            double a = tri_area(ps[i - 1], ps[i], ps[i + 1]);
+            area[i] = (a < removed ? removed : a);
+        }
+    }
+    free(area);
+    return count;
+}
+
+DEF_TEST(simplify_drops_collinear_points) {
+    scaled_point ps[100];
+    for (size_t i = 0; i < 100; i++) {
+        ps[i] = (scaled_point){ .x = 3 * i, .y = 2 * i + 5 };
+    }
+    ASSERT_EQ_FMT((size_t)2, simplify_polyline(ps, 100, 0.01), "%zu");
+    ASSERT_EQ(0, ps[0].x);
+    ASSERT_EQ(297, ps[1].x);
+    PASS();
+}
+
+DEF_TEST(simplify_keeps_large_features) {
+    scaled_point ps[] = {
+        { 0, 0 }, { 1, 0 }, { 2, 1 }, { 3, 0 }, { 4, 0 },
+        { 5, 20 }, { 6, 0 }, { 7, 0 },
+    };
+    size_t count = simplify_polyline(ps, 8, 3);
+    // the 1 pixel bump goes, but not the 20 pixel spike
+    ASSERT_EQ_FMT((size_t)5, count, "%zu");
+    ASSERT_EQ(0, ps[0].x);
+    ASSERT_EQ(4, ps[1].x);
+    ASSERT_EQ(5, ps[2].x);
+    ASSERT_EQ(6, ps[3].x);
+    ASSERT_EQ(7, ps[4].x);
+    PASS();
+}
+
+DEF_TEST(simplify_zero_tolerance_keeps_everything) {
+    scaled_point ps[] = { { 0, 0 }, { 1, 1 }, { 2, 2 }, { 2, 2 } };
+    ASSERT_EQ_FMT((size_t)4, simplify_polyline(ps, 4, 0), "%zu");
+    PASS();
+}
+
+DEF_TEST(simplify_matches_reference) {
+    uint64_t state = 11;
+    scaled_point got[300], want[300];
+    for (size_t round = 0; round < 200; round++) {
+        // random walks, some of them looping back on themselves
+        size_t count = 1 + prng(&state) % 300;
+        int32_t x = 0, y = 0;
+        for (size_t i = 0; i < count; i++) {
+            x += (int32_t)(prng(&state) % 9) - (round & 1 ? 4 : 1);
+            y += (int32_t)(prng(&state) % 9) - 4;
+            got[i] = want[i] = (scaled_point){ .x = x, .y = y };
+        }
+        double min_area = (prng(&state) % 40) / 4.0;
+
+        size_t got_count = simplify_polyline(got, count, min_area);
+        size_t want_count = ref_simplify(want, count, min_area);
+        ASSERT_EQ_FMT(want_count, got_count, "%zu");
+        for (size_t i = 0; i < got_count; i++) {
+            ASSERT_EQ(want[i].x, got[i].x);
+            ASSERT_EQ(want[i].y, got[i].y);
+        }
+    }
+    PASS();
+}
+
+SUITE(s_simplify) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(simplify_drops_collinear_points);
+    RUN_TEST(simplify_keeps_large_features);
+    RUN_TEST(simplify_zero_tolerance_keeps_everything);
+    RUN_TEST(simplify_matches_reference);
+}
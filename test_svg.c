@@ -0,0 +1,307 @@
+#include "test_guff.h"
+
+#include <ctype.h>
+
+#include "draw.h"
+#include "input.h"
+#include "input_internal.h"
+#include "svg.h"
+#include "scale.h"
+
+static void setup_cb(void *data) {
+}
+
+static void teardown_cb(void *data) {
+}
+
+#define OUT_SIZE (256 * 1024)
+
+static char out[OUT_SIZE];
+
+static svg_theme theme = {
+    .bg_color = "black",
+    .border_color = "black",
+    .axis_color = "gray",
+    .colors = { "c0", "c1", "c2", "c3", "c4", "c5", "c6", "c7", "c8" },
+    .line_width = 2,
+    .axis_width = 2,
+    .border_width = 2,
+};
+
+struct frame {
+    config *cfg;
+    const char **lines;
+    size_t count;
+};
+
+static int draw_frame(void *udata) {
+    struct frame *f = udata;
+    data_set ds = { .ys = NULL };
+    init_columns(&ds);
+    for (size_t i = 0; i < f->count; i++) {
+        sink_line(f->cfg, &ds, f->lines[i], strlen(f->lines[i]), i);
+    }
+    int res = draw(f->cfg, &ds);
+    draw_close(f->cfg);
+    input_free(&ds);
+    return res;
+}
+
+/* Draw LINES as one SVG frame, saving the output in out. */
+static greatest_test_res plot(config *cfg, const char **lines, size_t count) {
+    cfg->plot_type = PLOT_SVG;
+    cfg->svg_theme = &theme;
+    if (cfg->width == 0) { cfg->width = 100; }
+    if (cfg->height == 0) { cfg->height = 50; }
+    struct frame f = { .cfg = cfg, .lines = lines, .count = count };
+    ASSERT_EQ(0, capture_stdout(draw_frame, &f, out, OUT_SIZE));
+    PASS();
+}
+
+static size_t count_str(const char *s, const char *needle) {
+    size_t count = 0;
+    for (s = strstr(s, needle); s; s = strstr(s + 1, needle)) { count++; }
+    return count;
+}
+
+/* How many vertices are in the compact path with class CLASS? */
+static size_t path_vertices(const char *s, const char *class) {
+    char head[32];
+    snprintf(head, sizeof(head), "class=\"%s\" d=\"", class);
+    s = strstr(s, head);
+    if (s == NULL) { return 0; }
+    size_t numbers = 0;
+    bool in_number = false;
+    for (s += strlen(head); *s != '"'; s++) {
+        bool digit = isdigit((unsigned char)*s);
+        if (digit && !in_number) { numbers++; }
+        in_number = digit;
+    }
+    return numbers / 2;
+}
+
+/* Both columns land on the same three pixels, two of them more than once. */
+static const char *repeats[] = {
+    "0 0 0",
+    "5 5 5",
+    "5 5 5",
+    "5 5 5",
+    "10 10 10",
+    "10 10 10",
+};
+
+DEF_TEST(dots_drawn_once_per_pixel_per_column) {
+    config cfg = { .x_column = true };
+    CHECK_CALL(plot(&cfg, repeats, sizeof(repeats)/sizeof(repeats[0])));
+    ASSERT_EQ_FMT((size_t)6, count_str(out, "<circle"), "%zu");
+    // each column is deduped on its own
+    ASSERT_EQ_FMT((size_t)3, count_str(out, "stroke=\"c0\""), "%zu");
+    ASSERT_EQ_FMT((size_t)3, count_str(out, "stroke=\"c1\""), "%zu");
+    PASS();
+}
+
+DEF_TEST(compact_dots_drawn_once_per_pixel_per_column) {
+    config cfg = { .x_column = true, .svg_compact = true };
+    CHECK_CALL(plot(&cfg, repeats, sizeof(repeats)/sizeof(repeats[0])));
+    ASSERT_EQ_FMT((size_t)3, path_vertices(out, "d0"), "%zu");
+    ASSERT_EQ_FMT((size_t)3, path_vertices(out, "d1"), "%zu");
+    PASS();
+}
+
+DEF_TEST(dots_deduped_afresh_each_frame) {
+    static char first[OUT_SIZE];
+    config cfg = { .x_column = true };
+    CHECK_CALL(plot(&cfg, repeats, sizeof(repeats)/sizeof(repeats[0])));
+    memcpy(first, out, OUT_SIZE);
+
+    // a frame with only the already drawn pixels still draws them
+    CHECK_CALL(plot(&cfg, &repeats[1], 4));
+    ASSERT_EQ_FMT((size_t)2, count_str(out, "stroke=\"c0\""), "%zu");
+    ASSERT_EQ_FMT((size_t)2, count_str(out, "stroke=\"c1\""), "%zu");
+
+    CHECK_CALL(plot(&cfg, repeats, sizeof(repeats)/sizeof(repeats[0])));
+    ASSERT_STR_EQ(first, out);
+    PASS();
+}
+
+#define MAX_VERTICES (16 * 1024)
+
+/* Read every polyline's vertices from out into VS, with a SCALED_EMPTY
+ * vertex after each line. Returns how many were read. */
+static size_t read_polylines(scaled_point *vs) {
+    const char *head = "<polyline points=\"";
+    size_t n = 0;
+    for (const char *s = strstr(out, head); s; s = strstr(s, head)) {
+        s += strlen(head);
+        int x, y, len;
+        while (sscanf(s, " %d,%d%n", &x, &y, &len) == 2) {
+            assert(n < MAX_VERTICES);
+            vs[n++] = (scaled_point){ .x = x, .y = y };
+            s += len;
+        }
+        assert(n < MAX_VERTICES);
+        vs[n++] = (scaled_point){ .x = SCALED_EMPTY, .y = SCALED_EMPTY };
+    }
+    return n;
+}
+
+/* Scale LINES' first Y column as svg_plot would, but without
+ * decimating it, into VS. Empty points are SCALED_EMPTY. */
+static void undecimated(config *cfg, const char **lines, size_t count,
+        scaled_point *vs) {
+    data_set ds = { .ys = NULL };
+    init_columns(&ds);
+    for (size_t i = 0; i < count; i++) {
+        sink_line(cfg, &ds, lines[i], strlen(lines[i]), i);
+    }
+    plot_info pi;
+    memset(&pi, 0, sizeof(pi));
+    draw_calc_bounds(&ds, &pi);
+    pi.w = cfg->width;
+    pi.h = cfg->height;
+    assert(ds.rows == count);
+    scale_points(&pi, DS_XS(&ds, 0), DS_YS(&ds, 0), count,
+        scale_get_plot_transform(&pi), vs);
+    input_free(&ds);
+}
+
+/* Decimate PS the slow way: split it into lines at empty points, and
+ * keep the first, lowest, highest, and last of each run of points in
+ * the same pixel column, in order. Lines end with a SCALED_EMPTY
+ * vertex, like read_polylines's. Returns how many vertices there are. */
+static size_t m4_reference(const scaled_point *ps, size_t count, scaled_point *out) {
+    size_t n = 0;
+    size_t i = 0;
+    while (i < count) {
+        if (ps[i].x == SCALED_EMPTY) { i++; continue; }
+        while (i < count && ps[i].x != SCALED_EMPTY) {
+            size_t run = i;
+            size_t lo = i, hi = i;
+            for (; i < count && ps[i].x == ps[run].x; i++) {
+                if (ps[i].y < ps[lo].y) { lo = i; }
+                if (ps[i].y > ps[hi].y) { hi = i; }
+            }
+            for (size_t j = run; j < i; j++) {
+                if (j == run || j == lo || j == hi || j == i - 1) { out[n++] = ps[j]; }
+            }
+        }
+        out[n++] = (scaled_point){ .x = SCALED_EMPTY, .y = SCALED_EMPTY };
+    }
+    return n;
+}
+
+static greatest_test_res vertices_match(const scaled_point *exp, size_t exp_count,
+        const scaled_point *got, size_t got_count) {
+    ASSERT_EQ_FMT(exp_count, got_count, "%zu");
+    for (size_t i = 0; i < exp_count; i++) {
+        ASSERT_EQ_FMT(exp[i].x, got[i].x, "%d");
+        ASSERT_EQ_FMT(exp[i].y, got[i].y, "%d");
+    }
+    PASS();
+}
+
+/* Draw LINES in line mode, and check the polylines drawn against
+ * decimating the undecimated path by hand. */
+static greatest_test_res lines_match_reference(config *cfg,
+        const char **lines, size_t count) {
+    static scaled_point ps[MAX_VERTICES], exp[MAX_VERTICES], got[MAX_VERTICES];
+    assert(count <= MAX_VERTICES / 2);
+    cfg->mode = MODE_LINE;
+    cfg->x_column = true;
+    CHECK_CALL(plot(cfg, lines, count));
+    undecimated(cfg, lines, count, ps);
+
+    size_t exp_count = m4_reference(ps, count, exp);
+    size_t got_count = read_polylines(got);
+    CHECK_CALL(vertices_match(exp, exp_count, got, got_count));
+    PASS();
+}
+
+DEF_TEST(lines_undecimated_when_sparse) {
+    // one point per pixel column, so nothing is dropped
+    const char *lines[] = { "0 3", "1 1", "2 4", "3 1", "4 5", "5 9" };
+    const size_t count = sizeof(lines)/sizeof(lines[0]);
+    static scaled_point ps[MAX_VERTICES], got[MAX_VERTICES];
+    config cfg = { .width = 100 };
+    CHECK_CALL(lines_match_reference(&cfg, lines, count));
+
+    undecimated(&cfg, lines, count, ps);
+    ps[count] = (scaled_point){ .x = SCALED_EMPTY, .y = SCALED_EMPTY };
+    CHECK_CALL(vertices_match(ps, count + 1, got, read_polylines(got)));
+    PASS();
+}
+
+DEF_TEST(lines_keep_first_min_max_last_in_order) {
+    // in the first pixel column: first, max, min, other points, last;
+    // in the last: first, min, max, last
+    const char *lines[] = {
+        "0 5", "0.01 9", "0.02 1", "0.03 4", "0.04 6", "0.05 3",
+        "10 5", "10 0", "10 8", "10 2", "10 4",
+    };
+    const size_t count = sizeof(lines)/sizeof(lines[0]);
+    static scaled_point ps[MAX_VERTICES], got[MAX_VERTICES];
+    config cfg = { .width = 20 };
+    CHECK_CALL(lines_match_reference(&cfg, lines, count));
+
+    undecimated(&cfg, lines, count, ps);
+    ASSERT_EQ(ps[0].x, ps[5].x);
+    ASSERT_EQ(ps[6].x, ps[10].x);
+    scaled_point exp[] = {
+        ps[0], ps[1], ps[2], ps[5],
+        ps[6], ps[7], ps[8], ps[10],
+        { .x = SCALED_EMPTY, .y = SCALED_EMPTY },
+    };
+    CHECK_CALL(vertices_match(exp, sizeof(exp)/sizeof(exp[0]),
+            got, read_polylines(got)));
+    PASS();
+}
+
+#define DENSE_ROWS 4000
+
+DEF_TEST(lines_decimated_to_4_vertices_per_pixel_column) {
+    static char bufs[DENSE_ROWS][32];
+    static const char *lines[DENSE_ROWS];
+    static scaled_point got[MAX_VERTICES];
+    uint64_t state = 23;
+    for (size_t i = 0; i < DENSE_ROWS; i++) {
+        snprintf(bufs[i], sizeof(bufs[i]), "%g %u",
+            i / 400.0, (unsigned)(prng(&state) % 1000));
+        lines[i] = bufs[i];
+    }
+    config cfg = { .width = 20 };
+    CHECK_CALL(lines_match_reference(&cfg, lines, DENSE_ROWS));
+
+    size_t got_count = read_polylines(got);
+    ASSERT(got_count <= 4 * cfg.width + 1);
+    size_t run = 0;
+    for (size_t i = 0; i < got_count; i++) {
+        run = (i > 0 && got[i].x == got[i - 1].x ? run + 1 : 1);
+        ASSERT(run <= 4);
+    }
+    PASS();
+}
+
+DEF_TEST(lines_break_at_empty_rows) {
+    // rows with only an X value are gaps in the line
+    const char *lines[] = {
+        "0 1", "0.1 3", "0.2 2", "1 2", "2", "3 4", "4", "5", "6 5", "7 1",
+    };
+    config cfg = { .width = 10 };
+    CHECK_CALL(lines_match_reference(&cfg, lines, sizeof(lines)/sizeof(lines[0])));
+    ASSERT_EQ_FMT((size_t)3, count_str(out, "<polyline"), "%zu");
+    PASS();
+}
+
+SUITE(s_svg) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(dots_drawn_once_per_pixel_per_column);
+    RUN_TEST(compact_dots_drawn_once_per_pixel_per_column);
+    RUN_TEST(dots_deduped_afresh_each_frame);
+
+    RUN_TEST(lines_undecimated_when_sparse);
+    RUN_TEST(lines_keep_first_min_max_last_in_order);
+    RUN_TEST(lines_decimated_to_4_vertices_per_pixel_column);
+    RUN_TEST(lines_break_at_empty_rows);
+}
@@ -0,0 +1,185 @@
+#include "test_guff.h"
+
+#include "window.h"
+#include "input.h"
+#include "input_internal.h"
+
+static data_set batch;
+static window *w;
+
+static void setup_cb(void *data) {
+    memset(&batch, 0, sizeof(batch));
+    w = NULL;
+}
+
+static void teardown_cb(void *data) {
+    input_free(&batch);
+    if (w) { window_free(w); }
+}
+
+/* Parse LINES into the batch data_set, as input_read would. */
+static void read_batch(config *cfg, const char **lines, size_t count) {
+    init_columns(&batch);
+    for (size_t i = 0; i < count; i++) {
+        sink_line(cfg, &batch, lines[i], strlen(lines[i]), i);
+    }
+}
+
+DEF_TEST(window_keeps_last_rows) {
+    config cfg = { .window_size = 4 };
+    w = window_new(4);
+
+    const char *first[] = { "1", "2", "3" };
+    read_batch(&cfg, first, 3);
+    window_append(w, &batch, false);
+
+    const char *second[] = { "4", "5", "6" };
+    read_batch(&cfg, second, 3);
+    window_append(w, &batch, false);
+
+    data_set view;
+    window_view(w, &view, false);
+    ASSERT_EQ(1, view.columns);
+    ASSERT_EQ(4, view.rows);
+    for (size_t r = 0; r < 4; r++) {
+        // rows are renumbered across batches
+        point exp = { .x = r + 2, .y = r + 3 };
+        ASSERT_EQUAL_T(&exp, &DS_POINT(&view, 0, r), type_point, NULL);
+    }
+
+    ASSERT(view.has_bounds);
+    point exp_min = { .x = 2, .y = 3 };
+    point exp_max = { .x = 5, .y = 6 };
+    ASSERT_EQUAL_T(&exp_min, &view.min, type_point, NULL);
+    ASSERT_EQUAL_T(&exp_max, &view.max, type_point, NULL);
+    PASS();
+}
+
+DEF_TEST(window_adds_columns) {
+    config cfg = { .window_size = 8, .x_column = true };
+    w = window_new(8);
+
+    const char *first[] = { "10 1", "20 2" };
+    read_batch(&cfg, first, 2);
+    window_append(w, &batch, true);
+
+    const char *second[] = { "30 3 300" };
+    read_batch(&cfg, second, 1);
+    window_append(w, &batch, true);
+
+    data_set view;
+    window_view(w, &view, false);
+    ASSERT_EQ(2, view.columns);
+    ASSERT_EQ(3, view.rows);
+    ASSERT(IS_EMPTY(view.ys[1][0]));
+    ASSERT(IS_EMPTY(view.ys[1][1]));
+    point exp = { .x = 30, .y = 300 };
+    ASSERT_EQUAL_T(&exp, &DS_POINT(&view, 1, 2), type_point, NULL);
+    ASSERT_EQ_FMT(10.0, view.min.x, "%g");
+    ASSERT_EQ_FMT(300.0, view.max.y, "%g");
+    PASS();
+}
+
+/* Check the window's incremental bounds against a full scan. */
+static greatest_test_res bounds_match_scan(data_set *view) {
+    point min = { .x = INFINITY, .y = INFINITY };
+    point max = { .x = -INFINITY, .y = -INFINITY };
+    for (uint8_t c = 0; c < view->columns; c++) {
+        for (size_t r = 0; r < view->rows; r++) {
+            double x = view->xs[r];
+            double y = view->ys[c][r];
+            if (IS_EMPTY(x) || IS_EMPTY(y)) { continue; }
+            if (x < min.x) { min.x = x; }
+            if (x > max.x) { max.x = x; }
+            if (y < min.y) { min.y = y; }
+            if (y > max.y) { max.y = y; }
+        }
+    }
+
+    if (min.x == INFINITY) {
+        ASSERT_FALSE(view->has_bounds);
+    } else {
+        ASSERT(view->has_bounds);
+        ASSERT_EQUAL_T(&min, &view->min, type_point, NULL);
+        ASSERT_EQUAL_T(&max, &view->max, type_point, NULL);
+    }
+    PASS();
+}
+
+DEF_TEST(window_bounds_match_scan) {
+    const size_t size = 37;
+    config cfg = { .window_size = size, .x_column = true };
+    w = window_new(size);
+    uint64_t state = 5;
+
+    char bufs[10][64];
+    const char *lines[10];
+    for (int round = 0; round < 500; round++) {
+        size_t count = 1 + prng(&state) % 10;
+        for (size_t i = 0; i < count; i++) {
+            // X, then up to three Y columns, some of them empty
+            size_t o = snprintf(bufs[i], sizeof(bufs[i]), "%d",
+                (int)(prng(&state) % 1000) - 500);
+            size_t cols = 1 + prng(&state) % 3;
+            for (size_t c = 0; c < cols; c++) {
+                if (prng(&state) % 5 == 0) {
+                    o += snprintf(&bufs[i][o], sizeof(bufs[i]) - o, ",");
+                } else {
+                    o += snprintf(&bufs[i][o], sizeof(bufs[i]) - o, ",%d",
+                        (int)(prng(&state) % 1000) - 500);
+                }
+            }
+            lines[i] = bufs[i];
+        }
+        read_batch(&cfg, lines, count);
+        window_append(w, &batch, true);
+
+        data_set view;
+        window_view(w, &view, false);
+        CHECK_CALL(bounds_match_scan(&view));
+    }
+    PASS();
+}
+
+/* Renumbered X values should stay distinct long after they outgrow a
+ * float's 24-bit mantissa. */
+DEF_TEST(window_renumbers_past_float_precision) {
+    const size_t size = 4;
+    const size_t rows = 1 << 20;
+    w = window_new(size);
+
+    double *xs = malloc(rows * sizeof(double));
+    double *ys = malloc(rows * sizeof(double));
+    assert(xs && ys);
+    for (size_t r = 0; r < rows; r++) { xs[r] = EMPTY_VALUE; ys[r] = 1; }
+    double *cols[] = { ys };
+    data_set big = { .columns = 1, .rows = rows, .xs = xs, .ys = cols };
+
+    // start the sequence just past 2^24
+    for (size_t i = 0; i < (1 << 24) / rows; i++) { window_append(w, &big, false); }
+    big.rows = 3;
+    window_append(w, &big, false);
+
+    data_set view;
+    window_view(w, &view, false);
+    ASSERT_EQ(size, view.rows);
+    for (size_t r = 0; r < size; r++) {
+        ASSERT_EQ_FMT((double)((1 << 24) - 1 + r), view.xs[r], "%.1f");
+    }
+    ASSERT_EQ_FMT((double)((1 << 24) - 1), view.min.x, "%.1f");
+    ASSERT_EQ_FMT((double)((1 << 24) + 2), view.max.x, "%.1f");
+
+    free(xs);
+    free(ys);
+    PASS();
+}
+
+SUITE(s_window) {
+    SET_SETUP(setup_cb, NULL);
+    SET_TEARDOWN(teardown_cb, NULL);
+
+    RUN_TEST(window_keeps_last_rows);
+    RUN_TEST(window_adds_columns);
+    RUN_TEST(window_bounds_match_scan);
+    RUN_TEST(window_renumbers_past_float_precision);
+}
@@ -9,8 +9,18 @@ typedef struct {
 typedef struct {
     uint8_t row_ceil2;
     uint8_t columns;
+    uint8_t column_alloc;   // columns allocated, which may exceed columns in use
     size_t rows;
-    point **pairs;  // p[col] -> p[row]
+    bool flip_xy;   // plot columns' values as X, and xs as Y
+    double *xs;     // xs[row], shared by every column
+    double **ys;    // ys[col] -> ys[col][row]
+
+    /* If has_bounds is set, min and max hold the bounds of the
+     * non-empty points, unflipped (x for xs, y for every column), so
+     * drawing doesn't need to scan for them. */
+    bool has_bounds;
+    point min;
+    point max;
 } data_set;
 
 typedef enum {
@@ -22,8 +32,18 @@ typedef enum {
     MODE_DOT,
     MODE_COUNT,
     MODE_LINE,
+    MODE_HEAT,
+    MODE_HEX,
 } plot_t;
 
+/* Bounds for one of the plot's axes, given with -X or -Y rather than
+ * fit to the data. */
+typedef struct {
+    bool pinned;
+    double min;
+    double max;
+} axis_pin;
+
 typedef struct {
     bool log_x;
     bool log_y;
@@ -35,10 +55,23 @@ typedef struct {
     bool stream_mode;
     bool colorblind;
     bool regression;
+    bool svg_compact;
     size_t width;
     size_t height;
+    size_t heat_bin;            // heat map and hexbin cell size, in pixels
+    double simplify_tol;        // line simplification tolerance, in pixels
+    size_t window_size;         // sliding window mode, if nonzero
+    size_t batch_rows;          // if nonzero, rows read per input_read call
+    axis_pin pin_x;
+    axis_pin pin_y;
     char *in_path;
     FILE *in;
+    struct input_map *in_map;
+    struct counter **counters;  // count mode's tables, kept between frames
+    uint8_t counter_count;
+    struct counter **partial_counters;  // per-thread counts, to merge into those
+    size_t partial_counter_count;
+    struct transform_cache *transform_cache;  // log-scaled columns, likewise
     output_t plot_type;
 
     struct svg_theme *svg_theme;
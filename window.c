@@ -0,0 +1,159 @@
+#include "window.h"
+
+/* Ring buffer of rows, and monotonic deques for the window's bounds. */
+
+/* Row SEQ (counting every row appended) is stored at both
+ * SEQ % size and SEQ % size + size, so the rows currently in the
+ * window are always one contiguous run, and can be drawn in place. */
+
+/* A candidate for the window's min or max, from row SEQ. */
+struct extreme {
+    size_t seq;
+    double v;
+};
+
+/* Candidates in increasing order of seq. For a min deque, the values
+ * are increasing too, so the front is the min; for max, decreasing. */
+struct deque {
+    size_t head;
+    size_t count;
+    struct extreme *items;      /* ring with room for the window size */
+};
+
+struct window {
+    size_t size;
+    size_t appended;            /* rows ever appended */
+    uint8_t columns;
+    double *xs;
+    double *ys[MAX_COLUMNS];
+    double *view_ys[MAX_COLUMNS];
+
+    struct deque min_x;
+    struct deque max_x;
+    struct deque min_y;
+    struct deque max_y;
+};
+
+static double *alloc_ring(size_t size) {
+    double *ring = malloc(2 * size * sizeof(double));
+    if (ring == NULL) { err(1, "malloc"); }
+    for (size_t i = 0; i < 2 * size; i++) { ring[i] = EMPTY_VALUE; }
+    return ring;
+}
+
+static void deque_init(struct deque *d, size_t size) {
+    d->head = 0;
+    d->count = 0;
+    d->items = malloc(size * sizeof(*d->items));
+    if (d->items == NULL) { err(1, "malloc"); }
+}
+
+window *window_new(size_t size) {
+    assert(size > 0);
+    window *w = calloc(1, sizeof(*w));
+    if (w == NULL) { err(1, "calloc"); }
+    w->size = size;
+    w->xs = alloc_ring(size);
+    deque_init(&w->min_x, size);
+    deque_init(&w->max_x, size);
+    deque_init(&w->min_y, size);
+    deque_init(&w->max_y, size);
+    return w;
+}
+
+/* Drop candidates from rows before OLDEST, which have left the window. */
+static void deque_expire(struct deque *d, size_t size, size_t oldest) {
+    while (d->count > 0 && d->items[d->head].seq < oldest) {
+        d->head = (d->head + 1) % size;
+        d->count--;
+    }
+}
+
+/* Add V from row SEQ, first dropping every candidate it supersedes:
+ * any older value that isn't below it (for a min deque), or above it
+ * (for a max deque), can never be the window's min or max again. */
+static void deque_push(struct deque *d, size_t size, size_t seq, double v, bool is_min) {
+    if (seq >= size) { deque_expire(d, size, seq - size + 1); }
+    while (d->count > 0) {
+        double back = d->items[(d->head + d->count - 1) % size].v;
+        if (is_min ? back < v : back > v) { break; }
+        d->count--;
+    }
+    assert(d->count < size);
+    d->items[(d->head + d->count) % size] = (struct extreme){ .seq = seq, .v = v };
+    d->count++;
+}
+
+void window_append(window *w, const data_set *ds, bool x_column) {
+    size_t size = w->size;
+
+    for (uint8_t c = w->columns; c < ds->columns; c++) {
+        w->ys[c] = alloc_ring(size);
+    }
+    if (ds->columns > w->columns) { w->columns = ds->columns; }
+
+    for (size_t r = 0; r < ds->rows; r++) {
+        size_t seq = w->appended++;
+        size_t i = seq % size;
+        double x = (x_column ? ds->xs[r] : (double)seq);
+        w->xs[i] = w->xs[i + size] = x;
+
+        double min_y = INFINITY;
+        double max_y = -INFINITY;
+        for (uint8_t c = 0; c < w->columns; c++) {
+            double y = (c < ds->columns ? ds->ys[c][r] : EMPTY_VALUE);
+            w->ys[c][i] = w->ys[c][i + size] = y;
+            if (IS_EMPTY(y)) { continue; }
+            if (y < min_y) { min_y = y; }
+            if (y > max_y) { max_y = y; }
+        }
+
+        // only rows with a complete point count towards the bounds
+        if (IS_EMPTY(x) || min_y > max_y) { continue; }
+        deque_push(&w->min_x, size, seq, x, true);
+        deque_push(&w->max_x, size, seq, x, false);
+        deque_push(&w->min_y, size, seq, min_y, true);
+        deque_push(&w->max_y, size, seq, max_y, false);
+    }
+}
+
+void window_view(window *w, data_set *ds, bool flip_xy) {
+    size_t rows = (w->appended < w->size ? w->appended : w->size);
+    size_t oldest = w->appended - rows;
+    size_t start = oldest % w->size;
+
+    for (uint8_t c = 0; c < w->columns; c++) {
+        w->view_ys[c] = &w->ys[c][start];
+    }
+
+    memset(ds, 0, sizeof(*ds));
+    ds->columns = w->columns;
+    ds->rows = rows;
+    ds->flip_xy = flip_xy;
+    ds->xs = &w->xs[start];
+    ds->ys = w->view_ys;
+
+    deque_expire(&w->min_x, w->size, oldest);
+    deque_expire(&w->max_x, w->size, oldest);
+    deque_expire(&w->min_y, w->size, oldest);
+    deque_expire(&w->max_y, w->size, oldest);
+
+    // all four deques get the same rows, so they're empty together
+    if (w->min_x.count > 0) {
+        ds->has_bounds = true;
+        ds->min.x = w->min_x.items[w->min_x.head].v;
+        ds->max.x = w->max_x.items[w->max_x.head].v;
+        ds->min.y = w->min_y.items[w->min_y.head].v;
+        ds->max.y = w->max_y.items[w->max_y.head].v;
+    }
+}
+
+void window_free(window *w) {
+    for (uint8_t c = 0; c < w->columns; c++) { free(w->ys[c]); }
+    free(w->xs);
+    free(w->min_x.items);
+    free(w->max_x.items);
+    free(w->min_y.items);
+    free(w->max_y.items);
+    free(w);
+}
@@ -0,0 +1,28 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include "guff.h"
+
+/* Sliding window over the most recent rows of an unbounded stream.
+ * Appending rows costs O(rows appended), independent of the window
+ * size, and the window's bounds are kept up to date as rows come and
+ * go, so drawing it doesn't need to rescan for them. */
+
+typedef struct window window;
+
+/* Allocate a window holding the most recent SIZE rows. */
+window *window_new(size_t size);
+
+/* Append DS's rows to the window, dropping the oldest rows as
+ * necessary. Unless X_COLUMN is set, the X values are renumbered to
+ * continue on from the rows appended before. */
+void window_append(window *w, const data_set *ds, bool x_column);
+
+/* Set DS to a view of the rows in the window, oldest first, with its
+ * bounds filled in. DS shares the window's storage: it is only valid
+ * until the next window_append, and must not be passed to input_free. */
+void window_view(window *w, data_set *ds, bool flip_xy);
+
+void window_free(window *w);
+
+#endif